@@ -6,164 +6,423 @@
 #include <pgmspace.h>
 #endif
 
-I2C_ssd1306::I2C_ssd1306(uint8_t width, uint8_t height, byte ssd1306_address) {
+//every bit of a nibble repeated scale times, for scale 2, 3 and 4
+static const uint16_t nibbleExpand[3][16] PROGMEM = {
+  {0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F, 0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF},
+  {0x000, 0x007, 0x038, 0x03F, 0x1C0, 0x1C7, 0x1F8, 0x1FF, 0xE00, 0xE07, 0xE38, 0xE3F, 0xFC0, 0xFC7, 0xFF8, 0xFFF},
+  {0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF, 0xF000, 0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF}
+};
+
+I2C_ssd1306::I2C_ssd1306(uint8_t width, uint8_t height, byte ssd1306_address) : _wireTransport(ssd1306_address) {
   _width = width;
   _height = height;
-  _addr = ssd1306_address;
-  _screenBuffer = (uint8_t *)malloc((width * (height + 7) / 8));
+  _screenBuffer = (uint8_t *)malloc(width * ((height + 7) >> 3));
+  _bufPages = (height + 7) >> 3;
+  for(uint8_t page = 0; page < SSD_MAX_PAGES; page++) clearDirty(page);
+}
+
+I2C_ssd1306::I2C_ssd1306(uint8_t width, uint8_t height, byte ssd1306_address, uint8_t *buffer) : _wireTransport(ssd1306_address) {
+  _width = width;
+  _height = height;
+  _screenBuffer = buffer;
+  _bufPages = (height + 7) >> 3;
+  for(uint8_t page = 0; page < SSD_MAX_PAGES; page++) clearDirty(page);
 }
 
 I2C_ssd1306_minimal::I2C_ssd1306_minimal(uint8_t width, uint8_t height, byte ssd1306_address){
   _width = width;
   _height = height;
-  _addr = ssd1306_address;
+  _wireTransport = SSD_WireTransport(ssd1306_address);
   _screenBuffer = (uint8_t *)malloc(width);
-  _endX = 0;
-  _startX = _width - 1;
+  _bufPages = 1;
+  for(uint8_t page = 0; page < SSD_MAX_PAGES; page++) clearDirty(page);
 }
 
 void I2C_ssd1306::begin(TwoWire &I2Cwire) {
-  wire = &I2Cwire;
+  _wireTransport.setWire(I2Cwire);
+  begin(_wireTransport);
+}
+
+void I2C_ssd1306::begin(SSD_Transport &transport) {
+  _transport = &transport;
+  _transport->begin();
   initialize();
 }
 
+//bytes of one transaction, control byte included. Applies to the transport begin() was given, before begin() to the Wire transport
+void I2C_ssd1306::setMaxI2CBytes(uint8_t maxBytes) {
+  SSD_Transport *transport = _transport != NULL ? _transport : &_wireTransport;
+  transport->setMaxChunk(maxBytes > 1 ? maxBytes - 1 : 1);
+}
+
 void I2C_ssd1306_minimal::display(){
-  if(_endX < _startX) return;
-  uint8_t addrResList[] = {
-    SSD_COMMAND_SET_PAGE_ADDRESS,
-    _currentPage, _height - 1,
-    SSD_COMMAND_SET_COLUMN_ADDRESS,
-    _startX, (_width - 1)
-  };
-  sendCommandList(addrResList, sizeof(addrResList));
+  while(displayStep(0xFFFF)); //its window commands would cut into a transfer that is already in flight
+  uint8_t startX = _dirtyStartX[_bufPage], endX = _dirtyEndX[_bufPage];
+  if(endX < startX || _scrolling) return;
+  #if SSD_STATS
+  uint32_t startTime = micros();
+  #endif
+  sendWindowCommands(_bufPage, ((_height + 7) >> 3) - 1, startX, _width - 1);
   #if defined(ESP8266)
   yield();
   #endif
-  uint8_t columnsCount = (_endX - _startX) + 1;
-  uint8_t bytesSent = 1;
-  uint8_t *ptr = _screenBuffer + _startX;
-  START_TRANSMISSION
-  wire->write(SSD_dataByte);
-  while (columnsCount--) {
-    if (bytesSent >= MAX_I2C_BYTES) {
-      END_TRANSMISSION
-      START_TRANSMISSION
-      wire->write(SSD_dataByte);
-      bytesSent = 1;
-    }
-    wire->write(*ptr++);
-    bytesSent++;
-  }
-  END_TRANSMISSION
-  _endX = 0;
-  _startX = _width - 1;
+  uint8_t columnsCount = (endX - startX) + 1, chunk;
+  uint8_t *ptr = _screenBuffer + startX;
+  while (columnsCount) {
+    chunk = columnsCount < _transport->getMaxChunk() ? columnsCount : _transport->getMaxChunk();
+    sendData(ptr, chunk);
+    ptr += chunk;
+    columnsCount -= chunk;
+  }
+  clearDirty(_bufPage);
+  SSD_STAT_ADD(displayMicros, micros() - startTime)
+  SSD_STAT_ADD(framesPresented, 1)
 }
 
 void I2C_ssd1306::display() {
-  uint8_t addrResList[] = {
-    SSD_COMMAND_SET_PAGE_ADDRESS,
-    0x00, _height - 1,
-    SSD_COMMAND_SET_COLUMN_ADDRESS,
-    0x00, (_width - 1)
-  };
-  
-  sendCommandList(addrResList, sizeof(addrResList));
-  #if defined(ESP8266)
-  yield();
-  #endif
-  uint16_t columnsCount = (_width * (_height + 7) / 8);
-  uint8_t bytesSent = 1;
-  uint8_t *ptr = _screenBuffer;
-  START_TRANSMISSION
-  wire->write(SSD_dataByte);
-  while (columnsCount--) {
-    if (bytesSent >= MAX_I2C_BYTES) {
-      END_TRANSMISSION
-      START_TRANSMISSION
-      wire->write(SSD_dataByte);
-      bytesSent = 1;
-    }
-    wire->write(*ptr++);
-    bytesSent++;
-  }
-  END_TRANSMISSION
-  #if defined(ESP8266)
-  yield();
+  while(displayStep(0xFFFF)); //finish a transfer that is already in flight
+  beginDisplay();
+  while(displayStep()){
+    #if defined(ESP8266)
+    yield();
+    #endif
+  }
+}
+
+/*
+  takes a snapshot of the dirty windows and starts a transfer that is sent by displayStep() calls.
+  Drawing while the transfer is in flight is allowed: changed bytes that weren't sent yet go out in this transfer,
+  the rest is marked dirty for the next one, so everything drawn is on the display after the next finished transfer.
+  Only the pages the buffer holds are sent, the minimal class sends its current page.
+  Returns false if the previous transfer isn't finished yet
+*/
+bool I2C_ssd1306::beginDisplay() {
+  if(isDisplayBusy() || _scrolling) return false; //GDDRAM must not be written while scrolling
+  uint8_t pagesCount = (_height + 7) >> 3;
+  if(_shadowBuffer != NULL && !_shadowValid) markDisplayDirty();
+  for(uint8_t page = 0; page < pagesCount; page++){
+    if((uint8_t)(page - _bufPage) < _bufPages){
+      _txStartX[page] = _dirtyStartX[page];
+      _txEndX[page] = _dirtyEndX[page];
+    }else{
+      _txStartX[page] = 0xFF;
+      _txEndX[page] = 0;
+    }
+    clearDirty(page);
+  }
+  _txBuffer = _screenBuffer;
+  _txBufPage = _bufPage;
+  //start line changed by the terminal goes out after the rows that were redrawn for it
+  _txStartLine = _startLineChanged ? _startLine : 0xFF;
+  _startLineChanged = false;
+  if(_frontBuffer != NULL){
+    //drawn frame becomes the front buffer, the new back buffer gets only the changed windows copied
+    _screenBuffer = _frontBuffer;
+    _frontBuffer = _txBuffer;
+    for(uint8_t page = 0; page < pagesCount; page++){
+      if(_txStartX[page] > _txEndX[page]) continue;
+      memcpy(_screenBuffer + page * _width + _txStartX[page], _txBuffer + page * _width + _txStartX[page], _txEndX[page] - _txStartX[page] + 1);
+    }
+  }
+  _txPage = 0;
+  _txX = 0;
+  _txWindowOpen = false;
+  return true;
+}
+
+/*
+  sends the transfer started by beginDisplay() one transaction at a time until at least maxBytes of data were sent,
+  returns true while there is something left to send
+*/
+bool I2C_ssd1306::displayStep(uint16_t maxBytes) {
+  uint16_t bytesSent = 0;
+  #if SSD_STATS
+  uint32_t startTime = micros();
   #endif
+  while(isDisplayBusy()){
+    if(!_txWindowOpen && !openWindow()) break;
+    bytesSent += sendChunk();
+    if(bytesSent >= maxBytes) break;
+  }
+  SSD_STAT_ADD(displayMicros, micros() - startTime)
+  return isDisplayBusy();
+}
+
+//waits for the transfer in flight to finish and begins the next one without waiting for it
+void I2C_ssd1306::present() {
+  while(displayStep(0xFFFF));
+  beginDisplay();
+}
+
+//calls displayStep() until the transfer is finished or maxMicros elapsed, returns true if it isn't finished
+bool I2C_ssd1306::displayFor(uint32_t maxMicros) {
+  uint32_t startTime = micros();
+  while(displayStep()){
+    if(micros() - startTime >= maxMicros) return true;
+  }
+  return false;
+}
+
+//finds the next window of the transfer and sends its address commands, returns false when everything was sent
+bool I2C_ssd1306::openWindow() {
+  uint8_t pagesCount = (_height + 7) >> 3, startX, endX;
+  for(; _txPage < pagesCount; _txPage++, _txX = 0){
+    startX = _txX > _txStartX[_txPage] ? _txX : _txStartX[_txPage];
+    endX = _txEndX[_txPage];
+    if(startX > endX) continue;
+    _txEndPage = _txPage;
+    if(_shadowValid){
+      //only the changed run, runs separated by a short unchanged gap are merged
+      uint8_t *buffer = _txBuffer + (_txPage - _txBufPage) * _width, *shadow = _shadowBuffer + _txPage * _width;
+      uint8_t x = startX, runEnd;
+      while(x <= endX && buffer[x] == shadow[x]) x++;
+      _bytesSaved += x - startX;
+      if(x > endX) continue;
+      startX = runEnd = x;
+      for(x++; x <= endX && x - runEnd <= SSD_DIFF_MERGE_GAP; x++){
+        if(buffer[x] != shadow[x]) runEnd = x;
+      }
+      if(x > endX) _bytesSaved += endX - runEnd;
+      endX = runEnd;
+    }else if(startX == _txStartX[_txPage]){
+      //following pages with the same dirty columns are sent in the same window
+      while(_txEndPage + 1 < pagesCount && _txStartX[_txEndPage + 1] == startX && _txEndX[_txEndPage + 1] == endX) _txEndPage++;
+    }
+    sendWindowCommands(_txPage, _txEndPage, startX, endX);
+    _txX = _txWindowStartX = startX;
+    _txWindowEndX = endX;
+    _txWindowOpen = true;
+    return true;
+  }
+  //transfer finished, everything the shadow buffer holds is now in GDDRAM
+  if(_shadowBuffer != NULL) _shadowValid = true;
+  SSD_STAT_ADD(framesPresented, 1)
+  if(_txStartLine != 0xFF) queueCommand(SSD_COMMAND_SET_START_LINE | _txStartLine);
+  _txStartLine = 0xFF;
+  flushCommands();
+  return false;
+}
+
+//queued commands are sent in the same transaction, ahead of the window address commands
+void I2C_ssd1306::sendWindowCommands(uint8_t startPage, uint8_t endPage, uint8_t startX, uint8_t endX) {
+  uint8_t addrResList[SSD_COMMAND_QUEUE_SIZE + 6];
+  uint8_t listSize = _cmdQueueLength;
+  memcpy(addrResList, _cmdQueue, _cmdQueueLength);
+  _cmdQueueLength = 0;
+  addrResList[listSize++] = SSD_COMMAND_SET_PAGE_ADDRESS;
+  addrResList[listSize++] = startPage;
+  addrResList[listSize++] = endPage;
+  addrResList[listSize++] = SSD_COMMAND_SET_COLUMN_ADDRESS;
+  addrResList[listSize++] = startX;
+  addrResList[listSize++] = endX;
+  sendCommandList(addrResList, listSize);
+}
+
+//sends one transaction of the open window's data, returns number of data bytes sent
+uint8_t I2C_ssd1306::sendChunk() {
+  //buffer holds the pages from _txBufPage on, shadow buffer is only used when that's page 0
+  uint16_t index = (_txPage - _txBufPage) * _width + _txX, bytesLeft = _txWindowEndX - _txX + 1;
+  //window spanning the whole width is contiguous in the buffer across its pages
+  bool wholeRows = _txWindowStartX == 0 && _txWindowEndX == _width - 1;
+  if(wholeRows) bytesLeft += (_txEndPage - _txPage) * _width;
+  uint8_t chunk = bytesLeft < _transport->getMaxChunk() ? bytesLeft : _transport->getMaxChunk();
+  sendData(_txBuffer + index, chunk);
+  if(_shadowBuffer != NULL) memcpy(_shadowBuffer + index, _txBuffer + index, chunk);
+  if(chunk < bytesLeft){
+    index += chunk;
+    _txPage = _txBufPage + index / _width;
+    _txX = index % _width;
+  }else if(!wholeRows && _txPage < _txEndPage){
+    _txPage++;
+    _txX = _txWindowStartX;
+  }else{
+    //window finished, the next one on this page starts after it
+    _txPage = _txEndPage;
+    _txX = _txWindowEndX + 1;
+    _txWindowOpen = false;
+  }
+  return chunk;
+}
+
+/*
+  keeps a copy of the last frame sent to the display and sends only bytes that differ from it,
+  so redrawing the whole frame (clearDisplay() and draw again) costs only what actually changed.
+  Uses another width * height / 8 bytes of RAM, returns false if it couldn't be allocated
+  or the buffer doesn't hold the whole display (minimal class)
+*/
+bool I2C_ssd1306::setFrameDiff(bool enable) {
+  while(displayStep(0xFFFF));
+  _shadowValid = false;
+  if(!enable){
+    free(_shadowBuffer);
+    _shadowBuffer = NULL;
+    return true;
+  }
+  if(_bufPages != ((_height + 7) >> 3)) return false;
+  if(_shadowBuffer == NULL) _shadowBuffer = (uint8_t *)malloc(_width * ((_height + 7) >> 3));
+  if(_shadowBuffer == NULL) return false;
+  return true;
+}
+
+/*
+  drawing goes to a back buffer while the front buffer is sent, beginDisplay()/present() swap them.
+  Uses another width * height / 8 bytes of RAM, returns false if it couldn't be allocated
+  or the buffer doesn't hold the whole display (minimal class)
+*/
+bool I2C_ssd1306::setDoubleBuffer(bool enable) {
+  while(displayStep(0xFFFF));
+  if(!enable){
+    if(_frontBuffer == NULL) return true;
+    //buffers are swapped every frame, drawing goes on in the one the display was made with
+    if(_screenBuffer == _allocatedBuffer){
+      memcpy(_frontBuffer, _screenBuffer, _width * ((_height + 7) >> 3));
+      _screenBuffer = _frontBuffer;
+    }
+    free(_allocatedBuffer);
+    _allocatedBuffer = _frontBuffer = NULL;
+    return true;
+  }
+  if(_bufPages != ((_height + 7) >> 3)) return false;
+  if(_frontBuffer == NULL) _frontBuffer = _allocatedBuffer = (uint8_t *)malloc(_width * ((_height + 7) >> 3));
+  if(_frontBuffer == NULL) return false;
+  memcpy(_frontBuffer, _screenBuffer, _width * ((_height + 7) >> 3));
+  return true;
+}
+
+/*
+  streaming writes GDDRAM straight from PROGMEM without the framebuffer, so the minimal class can show full screen images
+  and the buffer isn't needed for a boot screen. Opens the window for it, clipped to the display, returns false if nothing is visible.
+  A buffer that holds the whole display is sent over the window on the next display(), so GDDRAM matches the buffer again
+*/
+bool I2C_ssd1306::beginStream(uint8_t x, uint8_t page, uint8_t &width, uint8_t &pages) {
+  uint8_t displayPages = (_height + 7) >> 3;
+  while(displayStep(0xFFFF));
+  if(_scrolling || width == 0 || pages == 0 || x >= _width || page >= displayPages) return false;
+  width = width <= _width - x ? width : _width - x;
+  pages = pages <= displayPages - page ? pages : displayPages - page;
+  sendWindowCommands(page, page + pages - 1, x, x + width - 1);
+  if(_bufPages == displayPages){
+    for(uint8_t p = page; p < page + pages; p++) markDirty(p, x, x + width - 1);
+    _shadowValid = false;
+  }
+  return true;
+}
+
+//page-major bitmap (see drawBitmap()) written to GDDRAM at column x of the page as it is, clipped to the display
+void I2C_ssd1306::streamBitmap(const uint8_t *bitmap, uint8_t x, uint8_t page) {
+  uint8_t srcWidth = pgm_read_byte(&bitmap[0]), width = srcWidth, pages = (pgm_read_byte(&bitmap[1]) + 7) >> 3;
+  if(!beginStream(x, page, width, pages)) return;
+  bitmap += SSD_BITMAP_HEADER_SIZE;
+  //rows of an unclipped bitmap follow each other like the window does
+  uint8_t rows = width == srcWidth ? 1 : pages;
+  uint16_t rowLength = width == srcWidth ? (uint16_t)width * pages : width;
+  for(uint8_t row = 0; row < rows; row++){
+    const uint8_t *ptr = bitmap + row * srcWidth;
+    uint16_t left = rowLength;
+    while(left){
+      uint8_t chunk = left < _transport->getMaxChunk() ? left : _transport->getMaxChunk();
+      sendDataP(ptr, chunk);
+      ptr += chunk;
+      left -= chunk;
+    }
+  }
+}
+
+//compressed bitmap (see drawBitmapRLE()) decoded straight to GDDRAM at column x of the page, clipped to the display
+void I2C_ssd1306::streamBitmapRLE(const uint8_t *bitmap, uint8_t x, uint8_t page) {
+  uint8_t srcWidth = pgm_read_byte(&bitmap[0]), width = srcWidth, pages = (pgm_read_byte(&bitmap[1]) + 7) >> 3;
+  if(!beginStream(x, page, width, pages)) return;
+  rleDecoder decoder = {bitmap + SSD_BITMAP_HEADER_SIZE, 0, 0, 0};
+  uint8_t stage[SSD_STREAM_CHUNK];
+  uint8_t maxChunk = _transport->getMaxChunk() < SSD_STREAM_CHUNK ? _transport->getMaxChunk() : SSD_STREAM_CHUNK;
+  for(uint8_t row = 0; row < pages; row++){
+    uint8_t left = width;
+    while(left){
+      uint8_t chunk = left < maxChunk ? left : maxChunk;
+      decoder.read(stage, chunk);
+      sendData(stage, chunk);
+      left -= chunk;
+    }
+    decoder.read(NULL, srcWidth - width);
+  }
+}
+
+//sets width columns of the pages to value in GDDRAM, e.g. 0 to clear them, clipped to the display
+void I2C_ssd1306::streamFill(uint8_t value, uint8_t x, uint8_t page, uint8_t width, uint8_t pages) {
+  if(!beginStream(x, page, width, pages)) return;
+  uint16_t left = (uint16_t)width * pages;
+  while(left){
+    uint8_t chunk = left < _transport->getMaxChunk() ? left : _transport->getMaxChunk();
+    sendDataFill(value, chunk);
+    left -= chunk;
+  }
+}
+
+void I2C_ssd1306::markDisplayDirty() {
+  for(uint8_t page = 0; page < ((_height + 7) >> 3); page++){
+    _dirtyStartX[page] = 0;
+    _dirtyEndX[page] = _width - 1;
+  }
 }
 
 void I2C_ssd1306::clearDisplay() {
-  memset(_screenBuffer, 0, (_width * (_height + 7) / 8));
+  memset(_screenBuffer, 0, _width * ((_height + 7) >> 3));
+  markDisplayDirty();
 }
 
 void I2C_ssd1306_minimal::clearDisplay() {
   clearPage();
-  for(_currentPage = 0; _currentPage <= (_height + 7) >> 3; _currentPage++){
-    _endX = _width - 1;
-    _startX = 0;
-    display();
-  }
-  _currentPage = 0;
-  _endX = 0;
-  _startX = _width - 1;
+  streamFill(0, 0, 0, _width, (_height + 7) >> 3);
+  for(uint8_t page = 0; page < SSD_MAX_PAGES; page++) clearDirty(page);
+  _bufPage = 0;
 }
 
+//a transfer started by beginDisplay() is finished first, it's sent from the same buffer
 void I2C_ssd1306_minimal::clearPage(){
+    while(displayStep(0xFFFF));
     memset(_screenBuffer, 0, (_width));
 }
 
-void I2C_ssd1306_minimal::drawPixel(int16_t x, int16_t y, uint8_t color) {
-  if (x >= _width || y >= _height || x < 0 || y < 0) return;
-
-  if((y / 8) != _currentPage){
-    if(_mode == SSD_MINIMAL_MODE_AUTO){
-      display();
-      clearPage();
-      _currentPage = y / 8;
-      _endX = 0;
-      _startX = _width - 1;
-    }else return;
-  }
-  _endX = _endX < x ? x : _endX;
-  _startX = _startX > x ? x : _startX;
-  
-  switch (color) {
-    case SSD_COLOR_BLACK:
-      _screenBuffer[x] &= ~(1 << (y & 0b111));
-      break;
-    case SSD_COLOR_WHITE:
-      _screenBuffer[x] |= (1 << (y & 0b111));
-      break;
-    default:
-      _screenBuffer[x] ^= (1 << (y & 0b111));
-      break;
-  }
+/*
+  drawing outside of the current page: in auto mode the current page is displayed and the buffer switches to the new page,
+  in manual mode nothing is drawn
+*/
+bool I2C_ssd1306_minimal::pageMiss(uint8_t page) {
+  if(_mode != SSD_MINIMAL_MODE_AUTO) return false;
+  display();
+  clearPage();
+  _bufPage = page;
+  return true;
 }
 
 void I2C_ssd1306::drawPixel(int16_t x, int16_t y, uint8_t color) {
-  if (x >= _width || y >= _height || x < 0 || y < 0) return;
+  if ((uint16_t)x >= _width || (uint16_t)y >= _height) return;
 
+  uint8_t *row = pageRow(y >> 3, x, x);
+  if(row == NULL) return;
+  SSD_STAT_ADD(pixels[_statPrimitive], 1)
   switch (color) {
     case SSD_COLOR_BLACK:
-      _screenBuffer[((int)((y >> 3) * (_width)) + x)] &= ~(1 << (y & 0b111));
+      row[x] &= ~(1 << (y & 0b111));
       break;
     case SSD_COLOR_WHITE:
-      _screenBuffer[((int)((y >> 3) * (_width)) + x)] |= (1 << (y & 0b111));
+      row[x] |= (1 << (y & 0b111));
       break;
     default:
-      _screenBuffer[((int)((y >> 3) * (_width)) + x)] ^= (1 << (y & 0b111));
+      row[x] ^= (1 << (y & 0b111));
       break;
   }
 }
 
 void I2C_ssd1306::fillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color){
-  width--;
-  for(uint8_t i = 0; i < height; i++){
-    drawHLine(x, y + i, x + width, color);
-  }
+  SSD_STAT_PRIMITIVE(SSD_STAT_FILL_RECT)
+  if(width < 1 || height < 1 || x >= _width || y >= _height) return;
+  int16_t x1 = x + width - 1, y1 = y + height - 1;
+  rectSpan(x, x1 < _width ? x1 : _width - 1, y, y1 < _height ? y1 : _height - 1, color);
 }
 
 void I2C_ssd1306::fillRectRound(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t cornerRadius, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_FILL_RECT)
   if(width < 1 || height < 1) return;
   width--;
   height--;
@@ -180,6 +439,7 @@ void I2C_ssd1306::fillRectRound(uint8_t x, uint8_t y, uint8_t width, uint8_t hei
 }
 
 void I2C_ssd1306::fillCircle(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_FILL_CIRCLE)
   uint32_t x = radius, y = 0, radiusThreshold = radius * radius + radius;
   drawHLine(midX - x, midY, midX + x, color);
 
@@ -208,6 +468,7 @@ void I2C_ssd1306::fillCircle(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t
  |---|---|
 */
 void I2C_ssd1306::fillCircleQuarter(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t quarter, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_FILL_CIRCLE)
   uint32_t x = radius, y = 0, radiusThreshold = radius * radius + radius;
   if(quarter == 0 || quarter == 3) drawHLine(midX, midY, midX + x, color);
   else drawHLine(midX - x, midY, midX, color);
@@ -258,6 +519,7 @@ void I2C_ssd1306::fillCircleQuarter(uint8_t midX, uint8_t midY, uint8_t radius,
 }
 
 void I2C_ssd1306::drawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_RECT)
   drawHLine(x, y, x + width - 1, color);
   drawVLine(x + width - 1, y + 1, y + height - 1, color);
   drawHLine(x, y + height - 1, x + width - 2, color);
@@ -265,6 +527,7 @@ void I2C_ssd1306::drawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height,
 }
 
 void I2C_ssd1306::drawRectRound(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t cornerRadius, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_RECT)
   if(width < 1 || height < 1) return;
   width--;
   height--;
@@ -281,6 +544,7 @@ void I2C_ssd1306::drawRectRound(uint8_t x, uint8_t y, uint8_t width, uint8_t hei
 }
 
 void I2C_ssd1306::drawCircle(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t color) {
+  SSD_STAT_PRIMITIVE(SSD_STAT_CIRCLE)
   //calculating only one quarter of the circle until x is y
   //decreasing x everytime if x^2 + y^2 > r^2 + r
   //r^2 + r will be a 'radiusThreshold' for now, I don't know how to call it properly, cause I've come up with the formula
@@ -322,6 +586,7 @@ void I2C_ssd1306::drawCircle(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t
  |---|---|
 */
 void I2C_ssd1306::drawCircleQuarter(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t quarter, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_CIRCLE)
   uint32_t x = radius, y = 0, radiusThreshold = radius * radius + radius;
   
   if (radius != 0) {
@@ -384,6 +649,7 @@ void I2C_ssd1306::drawCircleQuarter(uint8_t midX, uint8_t midY, uint8_t radius,
 }
 
 void I2C_ssd1306::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint8_t color) {
+  SSD_STAT_PRIMITIVE(SSD_STAT_LINE)
   x0 = (x0 < _width) ? x0 : (_width - 1);
   y0 = (y0 < _height) ? y0 : (_height - 1);
   x1 = (x1 < _width) ? x1 : (_width - 1);
@@ -429,56 +695,308 @@ void I2C_ssd1306::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, uint8
 }
 
 void I2C_ssd1306::drawHLine(int16_t x0, int16_t y0, int16_t x1, uint8_t color) {
-  y0 = (y0 < _height) ? y0 : (_height - 1);
-  x0 = (x0 < _width) ? x0 : (_width - 1);
-  x1 = (x1 < _width) ? x1 : (_width - 1);
-  y0 = (y0 >= 0) ? y0 : (0);
+  SSD_STAT_PRIMITIVE(SSD_STAT_LINE)
+  if (x0 > x1) _swap_int16_t(x0, x1);
+  if (y0 < 0 || y0 >= _height || x1 < 0 || x0 >= _width) return;
   x0 = (x0 >= 0) ? x0 : (0);
-  x1 = (x1 >= 0) ? x1 : (0);
+  x1 = (x1 < _width) ? x1 : (_width - 1);
+  hSpan(x0, x1, y0, color);
+}
 
-  if (x0 > x1) _swap_int16_t(x0, x1);
-  
-  for (; x0 <= x1; x0++) {
-    drawPixel(x0, y0, color);
+//horizontal span in bounds, written to the page row directly with one bit mask
+void I2C_ssd1306::hSpan(uint8_t x0, uint8_t x1, uint8_t y, uint8_t color) {
+  uint8_t *ptr = pageRow(y >> 3, x0, x1);
+  if(ptr == NULL) return;
+  uint8_t mask = 1 << (y & 0b111), count = x1 - x0 + 1;
+  SSD_STAT_ADD(pixels[_statPrimitive], count)
+  ptr += x0;
+  switch (color) {
+    case SSD_COLOR_BLACK:
+      mask = ~mask;
+      while(count--) *ptr++ &= mask;
+      break;
+    case SSD_COLOR_WHITE:
+      while(count--) *ptr++ |= mask;
+      break;
+    default:
+      while(count--) *ptr++ ^= mask;
+      break;
   }
 }
 
 void I2C_ssd1306::drawVLine(int16_t x0, int16_t y0, int16_t y1, uint8_t color) {
-  y0 = (y0 < _height) ? y0 : (_height - 1);
-  x0 = (x0 < _width) ? x0 : (_width - 1);
-  y1 = (y1 < _height) ? y1 : (_height - 1);
+  SSD_STAT_PRIMITIVE(SSD_STAT_LINE)
+  if (y0 > y1) _swap_int16_t(y0, y1);
+  if (x0 < 0 || x0 >= _width || y1 < 0 || y0 >= _height) return;
   y0 = (y0 >= 0) ? y0 : (0);
-  x0 = (x0 >= 0) ? x0 : (0);
-  y1 = (y1 >= 0) ? y1 : (0);
+  y1 = (y1 < _height) ? y1 : (_height - 1);
+  rectSpan(x0, x0, y0, y1, color);
+}
 
-  if (y0 > y1) _swap_int16_t(y0, y1);
-  
-  for (; y0 <= y1; y0++) {
-    drawPixel(x0, y0, color);
+/*
+  rectangle in bounds, page by page: rows of the first and the last page are masked,
+  pages in between are whole bytes, memset for black and white
+*/
+void I2C_ssd1306::rectSpan(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, uint8_t color) {
+  uint8_t count = x1 - x0 + 1, lastPage = y1 >> 3;
+  for(uint8_t page = y0 >> 3; page <= lastPage; page++){
+    uint8_t *ptr = pageRow(page, x0, x1);
+    if(ptr == NULL) continue;
+    ptr += x0;
+    uint8_t mask = 0xFF, firstRow = 0, lastRow = 7;
+    if(page == (y0 >> 3)) { firstRow = y0 & 0b111; mask <<= firstRow; }
+    if(page == lastPage) { lastRow = y1 & 0b111; mask &= 0xFF >> (7 - lastRow); }
+    SSD_STAT_ADD(pixels[_statPrimitive], (uint16_t)count * (lastRow - firstRow + 1))
+    uint8_t n = count;
+    switch (color) {
+      case SSD_COLOR_BLACK:
+        if(mask == 0xFF) memset(ptr, 0, count);
+        else { mask = ~mask; while(n--) *ptr++ &= mask; }
+        break;
+      case SSD_COLOR_WHITE:
+        if(mask == 0xFF) memset(ptr, 0xFF, count);
+        else while(n--) *ptr++ |= mask;
+        break;
+      default:
+        while(n--) *ptr++ ^= mask;
+        break;
+    }
   }
 }
 
+/*
+  blitted one destination page at a time: the 8 XBM rows that land in the page are read and transposed
+  8 columns at a time into page bytes, so y doesn't need to be aligned to a page
+*/
 void I2C_ssd1306::drawXBM(const uint8_t *bitmap, uint8_t width, uint8_t height, uint8_t x0, uint8_t y0, uint8_t color){
-  height = height + y0 <= _height ?  height : _height - y0;
-  uint8_t bmpByte, widthInBytes = (width + 7) >> 3;
-  for(uint8_t y = 0; y < height; y++){
-    for(uint8_t x = 0; x < width; x++){
-      if((x & 0b111) == 0) bmpByte = pgm_read_byte(&bitmap[y * widthInBytes + (x >> 3)]);
-      if((bmpByte >> (x & 0b111)) & 1) drawPixel(x0 + x, y0 + y, color);
+  SSD_STAT_PRIMITIVE(SSD_STAT_BITMAP)
+  if(width == 0 || height == 0 || x0 >= _width || y0 >= _height) return;
+  height = height <= _height - y0 ? height : _height - y0;
+  uint8_t drawWidth = width <= _width - x0 ? width : _width - x0;
+  uint8_t widthInBytes = (width + 7) >> 3, firstPage = y0 >> 3, lastPage = (y0 + height - 1) >> 3;
+  uint8_t columns[8];
+  for(uint8_t page = firstPage; page <= lastPage; page++){
+    uint8_t *row = pageRow(page);
+    if(row == NULL) continue;
+    //bitmap row drawn to the top row of the page, negative on the first page when y isn't aligned
+    int16_t bandY = ((page - firstPage) << 3) - (y0 & 0b111);
+    for(uint8_t x = 0; x < drawWidth; x += 8){
+      xbmColumns(bitmap, widthInBytes, height, bandY, x >> 3, columns);
+      blitColumns(row, page, x0 + x, columns, drawWidth - x < 8 ? drawWidth - x : 8, color);
+    }
+  }
+}
+
+/*
+  bitmap in the native page-major format: page bytes go to the page rows as they are when y is aligned to a page,
+  otherwise every page byte is made of two bitmap pages shifted by y % 8
+*/
+void I2C_ssd1306::drawBitmap(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_BITMAP)
+  blitPages(bitmap + SSD_BITMAP_HEADER_SIZE, pgm_read_byte(&bitmap[0]), pgm_read_byte(&bitmap[1]), x0, y0, color);
+}
+
+//page bytes without the bitmap header, also the glyphs of page-major fonts and cached glyphs, which are in RAM
+void I2C_ssd1306::blitPages(const uint8_t *bitmap, uint8_t width, uint8_t height, uint8_t x0, uint8_t y0, uint8_t color, bool inRAM){
+  if(width == 0 || height == 0 || x0 >= _width || y0 >= _height) return;
+  uint8_t drawWidth = width <= _width - x0 ? width : _width - x0;
+  uint8_t shift = y0 & 0b111, firstPage = y0 >> 3, srcPages = (height + 7) >> 3;
+  uint8_t lastPage = (y0 + height - 1) >> 3;
+  if(lastPage >= ((_height + 7) >> 3)) lastPage = ((_height + 7) >> 3) - 1;
+  uint8_t columns[SSD_BLIT_CHUNK];
+  for(uint8_t page = firstPage; page <= lastPage; page++){
+    uint8_t *row = pageRow(page);
+    if(row == NULL) continue;
+    //low bitmap page lands in the rows from the shift down, the bitmap page above it in the rows above the shift
+    uint8_t srcPage = page - firstPage;
+    const uint8_t *low = srcPage < srcPages ? bitmap + srcPage * width : NULL;
+    const uint8_t *high = (shift && srcPage > 0) ? bitmap + (srcPage - 1) * width : NULL;
+    for(uint8_t x = 0; x < drawWidth; x += SSD_BLIT_CHUNK){
+      uint8_t count = drawWidth - x < SSD_BLIT_CHUNK ? drawWidth - x : SSD_BLIT_CHUNK;
+      const uint8_t *src = columns;
+      if(shift == 0){
+        if(inRAM) src = low + x;
+        else memcpy_P(columns, low + x, count);
+      }else if(inRAM){
+        for(uint8_t i = 0; i < count; i++){
+          columns[i] = (low ? low[x + i] << shift : 0) | (high ? high[x + i] >> (8 - shift) : 0);
+        }
+      }else{
+        for(uint8_t i = 0; i < count; i++){
+          columns[i] = (low ? pgm_read_byte(&low[x + i]) << shift : 0) | (high ? pgm_read_byte(&high[x + i]) >> (8 - shift) : 0);
+        }
+      }
+      blitColumns(row, page, x0 + x, src, count, color);
+    }
+  }
+}
+
+/*
+  compressed bitmap, decoded while it's drawn without a temporary copy. The page bytes of a destination page come from
+  two bitmap pages when y isn't aligned, so two decoders run a page apart and the lower one's state is handed
+  to the upper one at the end of every page. Chunks that decode to zeros aren't drawn
+*/
+void I2C_ssd1306::drawBitmapRLE(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_BITMAP)
+  uint8_t width = pgm_read_byte(&bitmap[0]), height = pgm_read_byte(&bitmap[1]);
+  if(width == 0 || height == 0 || x0 >= _width || y0 >= _height) return;
+  uint8_t drawWidth = width <= _width - x0 ? width : _width - x0;
+  uint8_t shift = y0 & 0b111, firstPage = y0 >> 3, srcPages = (height + 7) >> 3;
+  uint8_t lastPage = (y0 + height - 1) >> 3;
+  if(lastPage >= ((_height + 7) >> 3)) lastPage = ((_height + 7) >> 3) - 1;
+  rleDecoder low = {bitmap + SSD_BITMAP_HEADER_SIZE, 0, 0, 0}, high, pageStart;
+  uint8_t columns[SSD_BLIT_CHUNK], highColumns[SSD_BLIT_CHUNK];
+  for(uint8_t page = firstPage; page <= lastPage; page++){
+    uint8_t *row = pageRow(page);
+    uint8_t srcPage = page - firstPage;
+    bool hasLow = srcPage < srcPages, hasHigh = shift && srcPage > 0;
+    pageStart = low;
+    for(uint8_t x = 0; x < drawWidth; x += SSD_BLIT_CHUNK){
+      uint8_t count = drawWidth - x < SSD_BLIT_CHUNK ? drawWidth - x : SSD_BLIT_CHUNK;
+      bool lit = false;
+      if(hasLow) lit = low.read(columns, count);
+      else memset(columns, 0, count);
+      if(shift){
+        for(uint8_t i = 0; i < count; i++) columns[i] <<= shift;
+        if(hasHigh && high.read(highColumns, count)){
+          lit = true;
+          for(uint8_t i = 0; i < count; i++) columns[i] |= highColumns[i] >> (8 - shift);
+        }
+      }
+      if(lit && row != NULL) blitColumns(row, page, x0 + x, columns, count, color);
+    }
+    //columns clipped by the right edge
+    if(hasLow) low.read(NULL, width - drawWidth);
+    if(hasHigh) high.read(NULL, width - drawWidth);
+    high = pageStart;
+  }
+}
+
+//decodes the next count bytes into out, or skips them if out is NULL. Returns false if they are all zeros
+bool I2C_ssd1306::rleDecoder::read(uint8_t *out, uint8_t count) {
+  bool lit = false;
+  while(count){
+    if(left == 0){
+      code = pgm_read_byte(data++);
+      left = (code & (code < SSD_RLE_ZEROS ? 0x7F : 0x3F)) + 1;
+      if(code >= SSD_RLE_REPEAT) value = pgm_read_byte(data++);
+    }
+    uint8_t n = left < count ? left : count;
+    if(code < SSD_RLE_ZEROS){
+      if(out != NULL){
+        memcpy_P(out, data, n);
+        for(uint8_t i = 0; i < n && !lit; i++) lit = out[i];
       }
+      data += n;
+    }else if(out != NULL){
+      memset(out, code >= SSD_RLE_REPEAT ? value : 0, n);
+      lit = lit || (code >= SSD_RLE_REPEAT && value);
+    }
+    if(out != NULL) out += n;
+    left -= n;
+    count -= n;
+  }
+  return lit;
+}
+
+//8 columns of XBM byte column byteX, rows bandY to bandY + 7, as page bytes. Rows out of the bitmap are empty
+void I2C_ssd1306::xbmColumns(const uint8_t *bitmap, uint8_t widthInBytes, uint8_t height, int16_t bandY, uint8_t byteX, uint8_t columns[8]) {
+  uint8_t rows[8];
+  for(uint8_t r = 0; r < 8; r++){
+    int16_t y = bandY + r;
+    rows[r] = (y >= 0 && y < height) ? pgm_read_byte(&bitmap[y * widthInBytes + byteX]) : 0;
+  }
+  //8x8 bit transpose, Hacker's Delight 7-3. XBM is LSB first, so rows go in and columns come out in reverse order
+  uint32_t x = ((uint32_t)rows[7] << 24) | ((uint32_t)rows[6] << 16) | ((uint16_t)rows[5] << 8) | rows[4];
+  uint32_t y = ((uint32_t)rows[3] << 24) | ((uint32_t)rows[2] << 16) | ((uint16_t)rows[1] << 8) | rows[0];
+  uint32_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA; x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA; y = y ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+  columns[0] = y; columns[1] = y >> 8; columns[2] = y >> 16; columns[3] = y >> 24;
+  columns[4] = x; columns[5] = x >> 8; columns[6] = x >> 16; columns[7] = x >> 24;
+}
+
+/*
+  page bytes drawn to the buffer row from column x on, set bits are drawn with the color and clear bits are left as they are.
+  Only the columns from the first to the last byte with set bits are marked dirty
+*/
+void I2C_ssd1306::blitColumns(uint8_t *row, uint8_t page, uint8_t x, const uint8_t *columns, uint8_t count, uint8_t color) {
+  while(count && columns[count - 1] == 0) count--;
+  while(count && *columns == 0){
+    columns++;
+    x++;
+    count--;
+  }
+  if(count == 0) return;
+  markDirty(page, x, x + count - 1);
+  uint8_t *ptr = row + x;
+  #if SSD_STATS
+  if(_stats != NULL){
+    for(uint8_t i = 0; i < count; i++) _stats->pixels[_statPrimitive] += __builtin_popcount(columns[i]);
+  }
+  #endif
+  switch (color) {
+    case SSD_COLOR_BLACK:
+      while(count--) *ptr++ &= ~*columns++;
+      break;
+    case SSD_COLOR_WHITE:
+      while(count--) *ptr++ |= *columns++;
+      break;
+    default:
+      while(count--) *ptr++ ^= *columns++;
+      break;
   }
 }
 
-//http://ww1.microchip.com/downloads/en/AppNotes/01182b.pdf
-void I2C_ssd1306::setFont(const unsigned char *fonts){
+/*
+  http://ww1.microchip.com/downloads/en/AppNotes/01182b.pdf
+  with widthTable the char widths are copied to RAM (a byte per char of the font), so measuring and drawing text
+  doesn't read the char table for them. Returns false if the table couldn't be allocated, the font is set anyway
+*/
+bool I2C_ssd1306::setFont(const unsigned char *fonts, bool widthTable){
   _fontFamily = fonts;
   curFont.firstCharIndex = pgm_read_byte(&_fontFamily[0x03]) << 8 | pgm_read_byte_near(&_fontFamily[0x02]);
   curFont.lastCharIndex = pgm_read_byte(&_fontFamily[0x05]) << 8 | pgm_read_byte_near(&_fontFamily[0x04]);
   curFont.charHeight = pgm_read_byte(&_fontFamily[0x06]);
+  curFont.pageMajor = pgm_read_byte(&_fontFamily[0x00]) == SSD_FONT_PAGE_MAJOR;
+  free(_fontWidths);
+  _fontWidths = NULL;
+  if(!widthTable) return true;
+  _fontWidths = (uint8_t *)malloc(curFont.lastCharIndex - curFont.firstCharIndex + 1);
+  if(_fontWidths == NULL) return false;
+  for(uint16_t c = curFont.firstCharIndex; c <= curFont.lastCharIndex; c++){
+    _fontWidths[c - curFont.firstCharIndex] = pgm_read_byte(&_fontFamily[((c - curFont.firstCharIndex) << 2) + 8]);
+  }
+  return true;
+}
+
+//unscaled width of a char of the current font, 0 if the font doesn't have it
+uint8_t I2C_ssd1306::glyphWidth(uint8_t c){
+  if(c < curFont.firstCharIndex || c > curFont.lastCharIndex) return 0;
+  if(_fontWidths != NULL) return _fontWidths[c - curFont.firstCharIndex];
+  return pgm_read_byte(&_fontFamily[(((int)c - curFont.firstCharIndex) << 2) + 8]);
+}
+
+//glyph of a char the current font has
+const uint8_t *I2C_ssd1306::glyphData(uint8_t c){
+  uint16_t charHeadIndex =  (((int)c - curFont.firstCharIndex) << 2) + 8 ;
+  uint32_t charOffset = (((uint32_t)pgm_read_byte(&_fontFamily[charHeadIndex + 3])) << 16) | (((uint16_t)pgm_read_byte(&_fontFamily[charHeadIndex + 2])) << 8) | pgm_read_byte(&_fontFamily[charHeadIndex+1]);
+  return &_fontFamily[charOffset];
 }
 
 size_t I2C_ssd1306::write(uint8_t c){
-  uint8_t charBitmapByte, bitsLeft;
+  SSD_STAT_PRIMITIVE(SSD_STAT_TEXT)
+  if(_terminal) return writeTerminal(c);
+  return drawChar(c, textConf.textColor);
+}
+
+//measureText() follows the same rules, keep them in sync
+size_t I2C_ssd1306::drawChar(uint8_t c, uint8_t color){
   if(c == '\n'){ //transfer to new line
     _cursorX = 0;
     _cursorY += curFont.charHeight * textConf.textScale + textConf.lineSpacing;
@@ -491,72 +1009,440 @@ size_t I2C_ssd1306::write(uint8_t c){
     return 1;
   }
   else if(c < curFont.firstCharIndex || c > curFont.lastCharIndex) return 1;
-  uint16_t charHeadIndex =  (((int)c - curFont.firstCharIndex) << 2) + 8 ;
-  uint8_t charWidth = (pgm_read_byte(&_fontFamily[charHeadIndex]));
-  uint32_t charOffset = (((uint32_t)pgm_read_byte(&_fontFamily[charHeadIndex + 3])) << 16) | (((uint16_t)pgm_read_byte(&_fontFamily[charHeadIndex + 2])) << 8) | pgm_read_byte(&_fontFamily[charHeadIndex+1]);
-  for(uint8_t clmnByte = 0; clmnByte < ((charWidth + 7) >> 3); clmnByte++){
-    for(uint8_t y = 0; y < curFont.charHeight; y++){
-      charBitmapByte = pgm_read_byte(&_fontFamily[charOffset + y * ((charWidth + 7) >> 3) + clmnByte]);
-      bitsLeft = charWidth < (1 + clmnByte) << 3 ? (charWidth & 0b111) : 8;
-      for(uint8_t x = 0; x < bitsLeft; x++){
-        if((charBitmapByte >> x) & 1)
-          for(uint8_t sX = 0; sX < textConf.textScale; sX++)
-            for(uint8_t sY = 0; sY < textConf.textScale; sY++)
-              drawPixel(textConf.offsetX + _cursorX + (clmnByte << 3) + x * textConf.textScale + sX, textConf.offsetY + _cursorY + y * textConf.textScale + sY, textConf.textColor);
+  uint8_t charWidth = glyphWidth(c);
+  drawGlyph(glyphData(c), charWidth, textConf.offsetX + _cursorX, textConf.offsetY + _cursorY, color);
+  _cursorX += charWidth * textConf.textScale + textConf.letterSpacing;
+  return 1;
+}
+
+/*
+  glyphs of page-major fonts are blitted like drawBitmap() images, MikroElektronika glyph rows are laid out
+  like XBM rows and go through the XBM blitter. Scaled glyphs are drawn as scale x scale blocks
+*/
+void I2C_ssd1306::drawGlyph(const uint8_t *glyph, uint8_t width, int16_t x, int16_t y, uint8_t color){
+  if(width == 0 || x >= _width || y >= _height) return;
+  uint8_t height = curFont.charHeight, scale = textConf.textScale;
+  if(_glyphCache != NULL){
+    uint8_t *cached = cachedGlyph(glyph, width);
+    if(cached != NULL){
+      blitPages(cached, width * scale, height * scale, x, y, color, true);
+      return;
+    }
+  }
+  if(scale == 1){
+    if(curFont.pageMajor) blitPages(glyph, width, height, x, y, color);
+    else drawXBM(glyph, width, height, x, y, color);
+    return;
+  }
+  if(scale <= SSD_MAX_EXPANDED_SCALE){
+    drawGlyphExpanded(glyph, width, x, y, color);
+    return;
+  }
+  uint8_t widthInBytes = (width + 7) >> 3, columns[8];
+  for(uint8_t page = 0; page < ((height + 7) >> 3); page++){
+    int16_t pageY = y + (page << 3) * scale;
+    if(pageY >= _height) break;
+    for(uint8_t cx = 0; cx < width; cx++){
+      int16_t blockX = x + cx * scale;
+      if(blockX >= _width) break;
+      uint8_t column;
+      if(curFont.pageMajor) column = pgm_read_byte(&glyph[page * width + cx]);
+      else{
+        if((cx & 0b111) == 0) xbmColumns(glyph, widthInBytes, height, page << 3, cx >> 3, columns);
+        column = columns[cx & 0b111];
+      }
+      for(uint8_t bit = 0; column; bit++, column >>= 1){
+        int16_t blockY = pageY + bit * scale;
+        if(blockY >= _height) break;
+        if(column & 1) fillRect(blockX, blockY, scale, scale, color);
+      }
+    }
+  }
+}
+
+/*
+  scale 2 to 4: a glyph page becomes a band of 8 * scale rows, every column byte is expanded with nibbleExpand
+  to 16-32 bits and written as whole page bytes, scale columns wide. Bands are drawn page by page in order
+*/
+void I2C_ssd1306::drawGlyphExpanded(const uint8_t *glyph, uint8_t width, uint8_t x, uint8_t y, uint8_t color){
+  uint8_t scale = textConf.textScale, height = curFont.charHeight, shift = y & 0b111, columns[8];
+  uint8_t displayPages = (_height + 7) >> 3;
+  uint16_t drawWidth = width * scale <= _width - x ? width * scale : _width - x;
+  const uint16_t *expand = nibbleExpand[scale - 2];
+  for(uint8_t srcPage = 0; srcPage < ((height + 7) >> 3); srcPage++){
+    uint16_t bandY = y + (srcPage << 3) * scale;
+    if(bandY >= _height) break;
+    uint8_t srcRows = height - (srcPage << 3) < 8 ? height - (srcPage << 3) : 8;
+    uint8_t firstPage = bandY >> 3, lastPage = (bandY + srcRows * scale - 1) >> 3;
+    if(lastPage >= displayPages) lastPage = displayPages - 1;
+    for(uint8_t page = firstPage; page <= lastPage; page++){
+      uint8_t *row = pageRow(page);
+      if(row == NULL) continue;
+      row += x;
+      //bits of the expanded column that land in this page
+      uint8_t bandByte = page - firstPage;
+      for(uint8_t cx = 0; cx * scale < drawWidth; cx++){
+        if((cx & 0b111) == 0) glyphColumns(glyph, width, srcPage, cx, columns);
+        uint8_t column = columns[cx & 0b111];
+        if(column == 0) continue;
+        uint32_t expanded = pgm_read_word(&expand[column & 0x0F]) | ((uint32_t)pgm_read_word(&expand[column >> 4]) << (scale << 2));
+        uint8_t pageByte = bandByte == 0 ? expanded << shift : expanded >> ((bandByte << 3) - shift);
+        if(pageByte == 0) continue;
+        uint8_t *ptr = row + cx * scale, count = drawWidth - cx * scale < scale ? drawWidth - cx * scale : scale;
+        markDirty(page, x + cx * scale, x + cx * scale + count - 1);
+        SSD_STAT_ADD(pixels[_statPrimitive], count * __builtin_popcount(pageByte))
+        switch (color) {
+          case SSD_COLOR_BLACK:
+            pageByte = ~pageByte;
+            while(count--) *ptr++ &= pageByte;
+            break;
+          case SSD_COLOR_WHITE:
+            while(count--) *ptr++ |= pageByte;
+            break;
+          default:
+            while(count--) *ptr++ ^= pageByte;
+            break;
+        }
       }
     }
   }
-  _cursorX += charWidth * textConf.textScale + textConf.letterSpacing;
-  return 1;
+}
+
+/*
+  keeps recently drawn glyphs of the current font and scale in RAM as page bytes, so drawing them again is a copy
+  without reading and expanding the font. Entries are as big as the widest glyph, as many as fit in the given bytes,
+  least recently used one is replaced. Changing the font or scale empties the cache. Scales above SSD_MAX_EXPANDED_SCALE
+  aren't cached. 0 bytes disables it, returns false if the RAM couldn't be allocated
+*/
+bool I2C_ssd1306::setGlyphCache(uint16_t bytes){
+  free(_glyphCache);
+  _glyphCache = NULL;
+  _glyphCacheBytes = 0;
+  _glyphCacheEntries = 0;
+  _glyphCacheHits = _glyphCacheMisses = 0;
+  if(bytes == 0) return true;
+  _glyphCache = (uint8_t *)malloc(bytes);
+  if(_glyphCache == NULL) return false;
+  _glyphCacheBytes = bytes;
+  _glyphCacheFont = NULL;
+  return true;
+}
+
+//splits the cache into entries for the current font and scale
+void I2C_ssd1306::resetGlyphCache(){
+  uint8_t scale = textConf.textScale;
+  uint16_t maxWidth = 0, glyphWidth;
+  for(uint16_t c = curFont.firstCharIndex; c <= curFont.lastCharIndex; c++){
+    glyphWidth = pgm_read_byte(&_fontFamily[((c - curFont.firstCharIndex) << 2) + 8]);
+    if(glyphWidth > maxWidth) maxWidth = glyphWidth;
+  }
+  _glyphCacheFont = _fontFamily;
+  _glyphCacheScale = scale;
+  _glyphCacheEntries = 0;
+  _glyphCacheClock = 0;
+  if(scale > SSD_MAX_EXPANDED_SCALE || maxWidth * scale > 255 || curFont.charHeight * scale > 255) return;
+  _glyphCacheEntrySize = maxWidth * scale * ((curFont.charHeight * scale + 7) >> 3);
+  uint16_t entries = _glyphCacheBytes / (sizeof(glyphCacheEntry) + _glyphCacheEntrySize);
+  _glyphCacheEntries = entries < 255 ? entries : 255;
+  memset(_glyphCache, 0, _glyphCacheEntries * sizeof(glyphCacheEntry));
+}
+
+//page bytes of the glyph at the current scale, decoded to the least recently used entry if it isn't cached. NULL if it can't be cached
+uint8_t *I2C_ssd1306::cachedGlyph(const uint8_t *glyph, uint8_t width){
+  if(_glyphCacheFont != _fontFamily || _glyphCacheScale != textConf.textScale) resetGlyphCache();
+  if(_glyphCacheEntries == 0) return NULL;
+  glyphCacheEntry *entries = (glyphCacheEntry *)_glyphCache;
+  uint8_t *slots = _glyphCache + _glyphCacheEntries * sizeof(glyphCacheEntry);
+  if(++_glyphCacheClock == 0){
+    //clock wrapped around, ages start over
+    for(uint8_t i = 0; i < _glyphCacheEntries; i++) if(entries[i].glyph != NULL) entries[i].lastUse = 0;
+    _glyphCacheClock = 1;
+  }
+  uint8_t oldest = 0;
+  for(uint8_t i = 0; i < _glyphCacheEntries; i++){
+    if(entries[i].glyph == glyph){
+      _glyphCacheHits++;
+      entries[i].lastUse = _glyphCacheClock;
+      return slots + i * _glyphCacheEntrySize;
+    }
+    if(entries[i].lastUse < entries[oldest].lastUse) oldest = i;
+  }
+  _glyphCacheMisses++;
+  entries[oldest].glyph = glyph;
+  entries[oldest].lastUse = _glyphCacheClock;
+  decodeGlyph(glyph, width, slots + oldest * _glyphCacheEntrySize);
+  return slots + oldest * _glyphCacheEntrySize;
+}
+
+//glyph as page bytes at the current scale, width * scale columns per page
+void I2C_ssd1306::decodeGlyph(const uint8_t *glyph, uint8_t width, uint8_t *out){
+  uint8_t scale = textConf.textScale, height = curFont.charHeight, columns[8];
+  uint8_t outWidth = width * scale, outPages = (height * scale + 7) >> 3;
+  memset(out, 0, outWidth * outPages);
+  for(uint8_t srcPage = 0; srcPage < ((height + 7) >> 3); srcPage++){
+    for(uint8_t cx = 0; cx < width; cx++){
+      if((cx & 0b111) == 0) glyphColumns(glyph, width, srcPage, cx, columns);
+      uint8_t column = columns[cx & 0b111];
+      if(column == 0) continue;
+      if(scale == 1){
+        out[srcPage * width + cx] = column;
+        continue;
+      }
+      const uint16_t *expand = nibbleExpand[scale - 2];
+      uint32_t expanded = pgm_read_word(&expand[column & 0x0F]) | ((uint32_t)pgm_read_word(&expand[column >> 4]) << (scale << 2));
+      //a glyph page expands to exactly scale pages
+      for(uint8_t k = 0; k < scale && srcPage * scale + k < outPages; k++){
+        memset(out + (srcPage * scale + k) * outWidth + cx * scale, (uint8_t)(expanded >> (k << 3)), scale);
+      }
+    }
+  }
+}
+
+//column bytes of a glyph page, 8 columns from the column cx which is a multiple of 8
+void I2C_ssd1306::glyphColumns(const uint8_t *glyph, uint8_t width, uint8_t page, uint8_t cx, uint8_t columns[8]){
+  if(curFont.pageMajor) memcpy_P(columns, &glyph[page * width + cx], width - cx < 8 ? width - cx : 8);
+  else xbmColumns(glyph, (width + 7) >> 3, curFont.charHeight, page << 3, cx >> 3, columns);
 }
 
 void I2C_ssd1306::drawText(const char text[], uint8_t color){
-  uint8_t charWidth, charBitmapByte, bitsLeft;
-  uint16_t charHeadIndex;
-  uint32_t charOffset;
-  for(uint16_t i = 0; i < strlen((char *)text); i++){
-    if(text[i] == '\n'){ //transfer to new line
-      _cursorX = 0;
-      _cursorY += curFont.charHeight * textConf.textScale + textConf.lineSpacing;
-      continue;
+  drawText(text, false, color);
+}
+
+//F() strings are read from flash
+void I2C_ssd1306::drawText(const __FlashStringHelper *text, uint8_t color){
+  drawText((const char *)text, true, color);
+}
+
+void I2C_ssd1306::drawText(const char *text, bool inFlash, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_TEXT)
+  for(uint8_t c; (c = inFlash ? pgm_read_byte(text) : *text) != 0; text++) drawChar(c, color);
+}
+
+//width of the widest line, see measureText()
+uint16_t I2C_ssd1306::getTextWidth(const char text[]){
+  uint16_t width, height;
+  measureText(text, false, width, height);
+  return width;
+}
+
+uint16_t I2C_ssd1306::getTextWidth(const __FlashStringHelper *text){
+  uint16_t width, height;
+  measureText((const char *)text, true, width, height);
+  return width;
+}
+
+/*
+  size of the text drawn with the current font, scale and spacing, in one pass over the string.
+  Lines are split at '\n' like drawText() does, width is the widest line without the letter spacing after its last char,
+  height is the lines' height and the line spacing between them
+*/
+void I2C_ssd1306::measureText(const char text[], uint16_t &width, uint16_t &height){
+  measureText(text, false, width, height);
+}
+
+void I2C_ssd1306::measureText(const __FlashStringHelper *text, uint16_t &width, uint16_t &height){
+  measureText((const char *)text, true, width, height);
+}
+
+void I2C_ssd1306::measureText(const char *text, bool inFlash, uint16_t &width, uint16_t &height){
+  const char *start = text;
+  int16_t lineWidth = 0;
+  bool lineEmpty = true;
+  uint8_t lines = 1, c;
+  width = 0;
+  for(; (c = inFlash ? pgm_read_byte(text) : *text) != 0; text++){
+    if(c == '\n'){
+      if(!lineEmpty && lineWidth - textConf.letterSpacing > (int16_t)width) width = lineWidth - textConf.letterSpacing;
+      lineWidth = 0;
+      lineEmpty = true;
+      lines++;
+    }else if(c == ' ' || (c != '\r' && c >= curFont.firstCharIndex && c <= curFont.lastCharIndex)){
+      lineWidth += getCharWidth(c);
+      lineEmpty = false;
     }
-    else if(text[i] == '\r'){
-      continue;
-    }else if(text[i] == ' '){
-      _cursorX += textConf.textScale + textConf.letterSpacing;
+  }
+  if(!lineEmpty && lineWidth - textConf.letterSpacing > (int16_t)width) width = lineWidth - textConf.letterSpacing;
+  height = text == start ? 0 : lines * curFont.charHeight * textConf.textScale + (lines - 1) * textConf.lineSpacing;
+}
+
+/*
+  draws the text inside the box, wrapped at spaces and new lines, words wider than the box are split between chars.
+  flags are one of SSD_ALIGN_LEFT/CENTER/RIGHT, one of SSD_ALIGN_TOP/MIDDLE/BOTTOM and SSD_TEXT_ELLIPSIS.
+  Lines are laid out first, as many as fit in the box, then drawn, so nothing is drawn outside the box and
+  glyphs that wouldn't fit aren't drawn at all. Uses the font, scale and spacing like drawText(), but not the
+  cursor or text offset. Returns where the text that didn't fit starts, the length of the text if it all fit
+*/
+uint16_t I2C_ssd1306::drawTextBox(const char text[], uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags, uint8_t color){
+  return drawTextBox(text, false, x, y, width, height, flags, color);
+}
+
+uint16_t I2C_ssd1306::drawTextBox(const __FlashStringHelper *text, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags, uint8_t color){
+  return drawTextBox((const char *)text, true, x, y, width, height, flags, color);
+}
+
+uint16_t I2C_ssd1306::drawTextBox(const char *text, bool inFlash, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags, uint8_t color){
+  SSD_STAT_PRIMITIVE(SSD_STAT_TEXT)
+  struct
+  {
+    uint16_t start, end;
+    uint8_t width;
+  } lines[SSD_TEXT_BOX_LINES];
+  uint8_t lineHeight = curFont.charHeight * textConf.textScale, lineCount = 0, scale = textConf.textScale;
+  uint16_t next = 0;
+  //measuring pass, lines that fit in the box
+  while(lineCount < SSD_TEXT_BOX_LINES && (inFlash ? pgm_read_byte(text + next) : text[next]) != 0
+    && (lineCount + 1) * lineHeight + lineCount * textConf.lineSpacing <= height){
+    lines[lineCount].start = next;
+    next = layoutLine(text, inFlash, next, width, lines[lineCount].end, lines[lineCount].width);
+    lineCount++;
+  }
+  if(lineCount == 0) return next;
+  bool ellipsis = (flags & SSD_TEXT_ELLIPSIS) && (inFlash ? pgm_read_byte(text + next) : text[next]) != 0
+    && '.' >= curFont.firstCharIndex && '.' <= curFont.lastCharIndex;
+  uint8_t dotWidth = glyphWidth('.') * scale;
+  int16_t ellipsisWidth = 2 * getCharWidth('.') + dotWidth;
+  if(ellipsis){
+    //last line gets shorter to make room for the dots after it
+    layoutLine(text, inFlash, lines[lineCount - 1].start, width - ellipsisWidth - textConf.letterSpacing, lines[lineCount - 1].end, lines[lineCount - 1].width);
+    if(lines[lineCount - 1].width) lines[lineCount - 1].width += textConf.letterSpacing;
+    lines[lineCount - 1].width += ellipsisWidth;
+    //text cut off for the dots didn't fit either
+    next = lines[lineCount - 1].end;
+  }
+  //drawing pass
+  int16_t lineY = y;
+  uint8_t textHeight = lineCount * lineHeight + (lineCount - 1) * textConf.lineSpacing;
+  if(flags & SSD_ALIGN_MIDDLE) lineY += (height - textHeight) >> 1;
+  else if(flags & SSD_ALIGN_BOTTOM) lineY += height - textHeight;
+  for(uint8_t line = 0; line < lineCount; line++, lineY += lineHeight + textConf.lineSpacing){
+    int16_t lineX = x, boxEnd = x + width;
+    if(lines[line].width < width){
+      if(flags & SSD_ALIGN_CENTER) lineX += (width - lines[line].width) >> 1;
+      else if(flags & SSD_ALIGN_RIGHT) lineX += width - lines[line].width;
+    }
+    int16_t cursorX = lineX;
+    for(uint16_t i = lines[line].start; i < lines[line].end; i++){
+      uint8_t c = inFlash ? pgm_read_byte(text + i) : text[i];
+      if(c == '\r' || (c != ' ' && (c < curFont.firstCharIndex || c > curFont.lastCharIndex))) continue;
+      uint8_t charWidth = glyphWidth(c);
+      //a glyph that doesn't fit is only possible when it's wider than the box
+      if(c != ' ' && cursorX + charWidth * scale <= boxEnd) drawGlyph(glyphData(c), charWidth, cursorX, lineY, color);
+      cursorX += getCharWidth(c);
+    }
+    if(ellipsis && line == lineCount - 1){
+      cursorX = lineX + lines[line].width - ellipsisWidth;
+      for(uint8_t dot = 0; dot < 3; dot++, cursorX += getCharWidth('.')){
+        if(cursorX + dotWidth <= boxEnd) drawGlyph(glyphData('.'), glyphWidth('.'), cursorX, lineY, color);
+      }
+    }
+  }
+  return next;
+}
+
+/*
+  lays out the line of a text box from start: end is where its chars end and lineWidth how wide they are without
+  trailing spaces. Returns where the next line starts, after the new line or the spaces the line was wrapped at
+*/
+uint16_t I2C_ssd1306::layoutLine(const char *text, bool inFlash, uint16_t start, int16_t width, uint16_t &end, uint8_t &lineWidth){
+  int16_t cursorX = 0, inkWidth = 0;
+  uint16_t breakEnd = 0xFFFF, i = start;
+  uint8_t breakWidth = 0, c;
+  bool afterGlyph = false;
+  for(;; i++){
+    c = inFlash ? pgm_read_byte(text + i) : text[i];
+    if(c == 0 || c == '\n') break;
+    if(c == '\r' || (c != ' ' && (c < curFont.firstCharIndex || c > curFont.lastCharIndex))) continue;
+    if(c == ' '){
+      //a line can be wrapped at the first space after a word
+      if(afterGlyph){
+        breakEnd = i;
+        breakWidth = inkWidth;
+        afterGlyph = false;
+      }
+      cursorX += getCharWidth(c);
       continue;
     }
-    if(text[i] < curFont.firstCharIndex || text[i] > curFont.lastCharIndex) continue;
-    charHeadIndex =  (((int)text[i] - curFont.firstCharIndex) << 2) + 8 ;
-    charWidth = (pgm_read_byte(&_fontFamily[charHeadIndex]));
-    charOffset = ((uint32_t)pgm_read_byte(&_fontFamily[charHeadIndex + 3]) << 16) | (pgm_read_byte(&_fontFamily[charHeadIndex + 2]) << 8) | pgm_read_byte(&_fontFamily[charHeadIndex+1]);
-    for(uint8_t clmnByte = 0; clmnByte < ((charWidth + 7) >> 3); clmnByte++){
-      for(uint8_t y = 0; y < curFont.charHeight; y++){
-        
-        charBitmapByte = pgm_read_byte(&_fontFamily[charOffset + y * ((charWidth + 7) >> 3) + clmnByte]);
-        bitsLeft = charWidth < (1 + clmnByte) << 3 ? (charWidth & 0b111) : 8;
-        for(uint8_t x = 0; x < bitsLeft; x++){
-        if((charBitmapByte >> x) & 1)
-          for(uint8_t sX = 0; sX < textConf.textScale; sX++)
-            for(uint8_t sY = 0; sY < textConf.textScale; sY++)
-              drawPixel(textConf.offsetX + _cursorX + (clmnByte << 3) + x * textConf.textScale + sX, textConf.offsetY + _cursorY + y * textConf.textScale + sY, textConf.textColor);
-        }
+    int16_t right = cursorX + glyphWidth(c) * textConf.textScale;
+    if(right > width && inkWidth > 0){
+      if(breakEnd != 0xFFFF){
+        end = breakEnd;
+        lineWidth = breakWidth;
+        for(i = breakEnd; (inFlash ? pgm_read_byte(text + i) : text[i]) == ' '; i++);
+        return i;
       }
+      end = i;
+      lineWidth = inkWidth;
+      return i;
     }
-    _cursorX += charWidth * textConf.textScale + textConf.letterSpacing;
+    afterGlyph = true;
+    inkWidth = right;
+    cursorX += getCharWidth(c);
   }
+  end = i;
+  lineWidth = inkWidth;
+  return c == '\n' ? i + 1 : i;
 }
 
-uint16_t I2C_ssd1306::getTextWidth(const char text[]){
-  uint8_t charWidth;
-  uint16_t charHeadIndex, width = 0;
-  for(uint16_t i = 0; i < strlen((char *)text); i++){
-    if(text[i] < curFont.firstCharIndex || text[i] > curFont.lastCharIndex) continue;
-    charHeadIndex =  (((int)text[i] - curFont.firstCharIndex) << 2) + 8 ;
-    charWidth = (pgm_read_byte(&_fontFamily[charHeadIndex]));
-    width += charWidth * textConf.textScale + textConf.letterSpacing;
+//advance of the cursor after the character is drawn
+uint8_t I2C_ssd1306::getCharWidth(uint8_t c){
+  if(c == ' ') return textConf.textScale + textConf.letterSpacing;
+  if(c < curFont.firstCharIndex || c > curFont.lastCharIndex) return 0;
+  return glyphWidth(c) * textConf.textScale + textConf.letterSpacing;
+}
+
+/*
+  console mode for print(): text wraps at the right edge and a new line at the bottom scrolls the screen by one text row.
+  On 64 row displays scrolling only changes the display start line, so just the new row is cleared and sent.
+  Rows are page aligned, row height is font height + line spacing rounded up to 8, 16 or 32.
+  Screen is cleared when the mode is switched
+*/
+bool I2C_ssd1306::setTerminalMode(bool enable){
+  if(enable && _bufPages != ((_height + 7) >> 3)) return false;
+  _terminal = enable;
+  _terminalRowHeight = 8;
+  while(_terminalRowHeight < curFont.charHeight * textConf.textScale + textConf.lineSpacing && _terminalRowHeight < _height) _terminalRowHeight <<= 1;
+  if(_startLine != 0){
+    _startLine = 0;
+    _startLineChanged = true;
   }
-  return width;
+  _cursorX = _cursorY = 0;
+  clearDisplay();
+  return true;
+}
+
+size_t I2C_ssd1306::writeTerminal(uint8_t c){
+  if(c == '\n'){
+    newTerminalRow();
+    return 1;
+  }
+  if(_cursorX + getCharWidth(c) > _width + textConf.letterSpacing) newTerminalRow();
+  //text rows are kept in logical coordinates, GDDRAM row is shifted by the display start line
+  uint8_t cursorY = _cursorY;
+  _cursorY = (_cursorY + _startLine) & (SSD_MAX_PAGES * 8 - 1);
+  drawChar(c, textConf.textColor);
+  _cursorY = cursorY;
+  return 1;
+}
+
+void I2C_ssd1306::newTerminalRow(){
+  uint8_t rowPages = _terminalRowHeight >> 3, page;
+  _cursorX = 0;
+  if(_cursorY + 2 * _terminalRowHeight <= _height){
+    _cursorY += _terminalRowHeight;
+    return;
+  }
+  if(_height == SSD_MAX_PAGES * 8){
+    //the top row becomes the bottom row
+    _startLine = (_startLine + _terminalRowHeight) & (SSD_MAX_PAGES * 8 - 1);
+    _startLineChanged = true;
+  }else{
+    //display start line would show rows that aren't in the buffer, text is moved in the buffer instead
+    memmove(_screenBuffer, _screenBuffer + rowPages * _width, (((_height + 7) >> 3) - rowPages) * _width);
+    markDisplayDirty();
+  }
+  page = ((_cursorY + _startLine) & (SSD_MAX_PAGES * 8 - 1)) >> 3;
+  memset(_screenBuffer + page * _width, 0, rowPages * _width);
+  for(uint8_t i = page; i < page + rowPages; i++) markDirty(i, 0, _width - 1);
 }
 
 void I2C_ssd1306::setCursor(uint8_t column, uint8_t row){
@@ -575,53 +1461,173 @@ void I2C_ssd1306::advanceCursorRow(uint8_t rowCount, uint8_t column){
 }
 
 void I2C_ssd1306::setDisplayOn(bool displayOn){
-  if(displayOn) sendCommand(SSD_COMMAND_DISPLAY_ON);
-  else sendCommand(SSD_COMMAND_DISPLAY_OFF);
+  queueCommand(displayOn ? SSD_COMMAND_DISPLAY_ON : SSD_COMMAND_DISPLAY_OFF);
 }
 
 void I2C_ssd1306::invertDisplay(bool invert){
-  if(invert) sendCommand(SSD_COMMAND_SET_DISPLAY_INVERSE);
-  else sendCommand(SSD_COMMAND_SET_DISPLAY_NORMAL);
+  queueCommand(invert ? SSD_COMMAND_SET_DISPLAY_INVERSE : SSD_COMMAND_SET_DISPLAY_NORMAL);
 }
 
 void I2C_ssd1306::flipVertically(bool flip){
-  if(flip){
-    sendCommand(SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_INVERSE);
-  }else{
-    sendCommand(SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_NORMAL);
-  }
+  queueCommand(flip ? SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_INVERSE : SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_NORMAL);
 }
 
 void I2C_ssd1306::setContrast(uint8_t contrastValue) {
-  START_TRANSMISSION
-  wire->write(SSD_commandByte);
-  wire->write(SSD_COMMAND_CONTRAST);
-  wire->write(contrastValue);
-  END_TRANSMISSION
+  queueCommand(SSD_COMMAND_CONTRAST, contrastValue);
+}
+
+/*
+  scrolls pages startPage to endPage by one column every frameInterval (SSD_SCROLL_FRAMES_x) without any bus traffic.
+  Drawing is still possible, but display() doesn't send anything until stopScroll()
+*/
+void I2C_ssd1306::startScrollHorizontal(uint8_t direction, uint8_t startPage, uint8_t endPage, uint8_t frameInterval){
+  uint8_t scrollList[] = {
+    SSD_COMMAND_DEACTIVATE_SCROLL,
+    (uint8_t)(direction == SSD_SCROLL_LEFT ? SSD_COMMAND_LEFT_HORIZONTAL_SCROLL : SSD_COMMAND_RIGHT_HORIZONTAL_SCROLL),
+    0x00, startPage, frameInterval, endPage,
+    0x00, 0xFF,
+    SSD_COMMAND_ACTIVATE_SCROLL
+  };
+  startScroll(scrollList, sizeof(scrollList));
+}
+
+/*
+  same as horizontal scroll, additionally moves the vertical scroll area (see setVerticalScrollArea()) up by verticalOffset rows every step
+*/
+void I2C_ssd1306::startScrollDiagonal(uint8_t direction, uint8_t startPage, uint8_t endPage, uint8_t frameInterval, uint8_t verticalOffset){
+  uint8_t scrollList[] = {
+    SSD_COMMAND_DEACTIVATE_SCROLL,
+    (uint8_t)(direction == SSD_SCROLL_LEFT ? SSD_COMMAND_VERTICAL_LEFT_HORIZONTAL_SCROLL : SSD_COMMAND_VERTICAL_RIGHT_HORIZONTAL_SCROLL),
+    0x00, startPage, frameInterval, endPage,
+    verticalOffset,
+    SSD_COMMAND_ACTIVATE_SCROLL
+  };
+  startScroll(scrollList, sizeof(scrollList));
+}
+
+void I2C_ssd1306::startScroll(uint8_t *scrollList, uint8_t listSize){
+  while(displayStep(0xFFFF));
+  flushCommands();
+  sendCommandList(scrollList, listSize);
+  _scrolling = true;
+}
+
+//rows fixed at the top and rows that scroll vertically below them, by default the whole height scrolls
+void I2C_ssd1306::setVerticalScrollArea(uint8_t fixedTopRows, uint8_t scrollRows){
+  uint8_t areaList[] = {SSD_COMMAND_SET_VERTICAL_SCROLL_AREA, fixedTopRows, scrollRows};
+  flushCommands();
+  sendCommandList(areaList, sizeof(areaList));
+}
+
+/*
+  horizontal scroll moves the GDDRAM content, so after it's stopped the whole frame is sent again
+  on the next display() to match the buffer
+*/
+void I2C_ssd1306::stopScroll(){
+  flushCommands();
+  sendCommand(SSD_COMMAND_DEACTIVATE_SCROLL);
+  _scrolling = false;
+  _shadowValid = false;
+  markDisplayDirty();
+}
+
+/*
+  when deferred, display setting commands wait in a queue and are sent together with the next display() transfer
+  (or flushCommands()) in one transaction instead of one transaction each
+*/
+void I2C_ssd1306::setDeferredCommands(bool defer) {
+  _deferCommands = defer;
+  if(!defer) flushCommands();
+}
+
+void I2C_ssd1306::flushCommands() {
+  if(_cmdQueueLength == 0) return;
+  uint8_t listSize = _cmdQueueLength;
+  _cmdQueueLength = 0;
+  sendCommandList(_cmdQueue, listSize);
+}
+
+/*
+  queues a setting command, a queued command setting the same thing is replaced,
+  so only the last contrast, inversion, etc. is sent
+*/
+void I2C_ssd1306::queueCommand(uint8_t command, int16_t argument) {
+  uint8_t i = 0, length;
+  while(i < _cmdQueueLength){
+    length = _cmdQueue[i] == SSD_COMMAND_CONTRAST ? 2 : 1;
+    if(commandKind(_cmdQueue[i]) == commandKind(command)){
+      _cmdQueueLength -= length;
+      memmove(_cmdQueue + i, _cmdQueue + i + length, _cmdQueueLength - i);
+    }else i += length;
+  }
+  if(_cmdQueueLength + 2 > SSD_COMMAND_QUEUE_SIZE) flushCommands();
+  _cmdQueue[_cmdQueueLength++] = command;
+  if(argument >= 0) _cmdQueue[_cmdQueueLength++] = argument;
+  if(!_deferCommands) flushCommands();
+}
+
+//commands that set the same thing have the same kind, e.g. display on and display off
+uint8_t I2C_ssd1306::commandKind(uint8_t command) {
+  switch (command) {
+    case SSD_COMMAND_DISPLAY_ON:
+    case SSD_COMMAND_SET_DISPLAY_INVERSE:
+      return command & 0xFE;
+    case SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_INVERSE:
+      return SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_NORMAL;
+    default:
+      if((command & 0xC0) == SSD_COMMAND_SET_START_LINE) return SSD_COMMAND_SET_START_LINE;
+      return command;
+  }
 }
 
 void I2C_ssd1306::sendCommand(uint8_t command) {
-  START_TRANSMISSION
-  wire->write(SSD_commandByte);
-  wire->write(command);
-  END_TRANSMISSION
+  sendCommandList(&command, 1);
 }
 
 void I2C_ssd1306::sendCommandList(uint8_t* c_ptr, uint8_t listSize) {
-  uint8_t bytesSent = 1;
-  START_TRANSMISSION
-  wire->write(SSD_commandByte);
-  while (listSize--) {
-    if (bytesSent >= MAX_I2C_BYTES) {
-      END_TRANSMISSION
-      START_TRANSMISSION
-      wire->write(SSD_commandByte);
-      bytesSent = 1;
-    }
-    wire->write((*c_ptr++));
-    bytesSent++;
+  uint8_t chunk;
+  while (listSize) {
+    chunk = listSize < _transport->getMaxChunk() ? listSize : _transport->getMaxChunk();
+    busResult(_transport->sendCommands(c_ptr, chunk));
+    SSD_STAT_ADD(commandBytes, chunk)
+    c_ptr += chunk;
+    listSize -= chunk;
+  }
+}
+
+void I2C_ssd1306::sendData(const uint8_t *data, uint8_t count) {
+  busResult(_transport->sendData(data, count));
+  SSD_STAT_ADD(dataBytes, count)
+}
+
+void I2C_ssd1306::sendDataP(const uint8_t *data, uint8_t count) {
+  uint8_t error = _transport->sendDataP(data, count);
+  busResult(error, _transport->takeTransactionCount());
+  SSD_STAT_ADD(dataBytes, count)
+}
+
+void I2C_ssd1306::sendDataFill(uint8_t value, uint8_t count) {
+  uint8_t error = _transport->sendDataFill(value, count);
+  busResult(error, _transport->takeTransactionCount());
+  SSD_STAT_ADD(dataBytes, count)
+}
+
+void I2C_ssd1306::busResult(uint8_t error, uint8_t transactions) {
+  #if SSD_STATS
+  if(_stats == NULL) return;
+  _stats->transactions += transactions;
+  if(error != 0){
+    _stats->busErrors++;
+    _stats->lastBusError = error;
   }
-  END_TRANSMISSION
+  #else
+  (void)error;
+  (void)transactions;
+  #endif
+}
+
+void I2C_ssd1306::resetStats() {
+  if(_stats != NULL) memset(_stats, 0, sizeof(SSD_Stats));
 }
 
 void I2C_ssd1306::initialize() {
@@ -630,14 +1636,14 @@ void I2C_ssd1306::initialize() {
   uint8_t initList[] = {
     SSD_COMMAND_DISPLAY_OFF,
     SSD_COMMAND_MUX_RATIO,
-    (_height - 1),
+    (uint8_t)(_height - 1),
     SSD_COMMAND_SET_PAGE_ADDRESS,
-    0, (_height / 8 - 1),
+    0, (uint8_t)(_height / 8 - 1),
     SSD_COMMAND_SET_COLUMN_ADDRESS,
-    0, (_width - 1),
+    0, (uint8_t)(_width - 1),
     SSD_COMMAND_DISPLAY_OFFSET,
     (0x00),
-    (0x40), //set display start line to 0
+    SSD_COMMAND_SET_START_LINE, //set display start line to 0
     SSD_COMMAND_SET_SEGMENT_RE_MAP | SSD_DISPLAY_FLIP_HORIZONTALLY,
     SSD_COMMAND_SET_COM_OUTPUT_SCAN_DIRECTION_INVERSE,
     SSD_COMMAND_COM_PINS_CONFIGURATION,
@@ -657,6 +1663,9 @@ void I2C_ssd1306::initialize() {
     SSD_COMMAND_DEACTIVATE_SCROLL,
     SSD_COMMAND_DISPLAY_ON
   };
+  _scrolling = false;
+  _startLine = 0;
+  _startLineChanged = false;
   sendCommandList(&initList[0], sizeof(initList));
   clearDisplay();
   display();
@@ -4,6 +4,7 @@
 
 #include "Arduino.h"
 #include "Print.h"
+#include "I2C_ssd1306_transport.h"
 
 #define SSD_COMMAND_DISPLAY_OFF 0xAE
 #define SSD_COMMAND_DISPLAY_ON 0xAF
@@ -23,8 +24,15 @@
 #define SSD_COMMAND_CHARGE_PUMP 0x8D
 #define SSD_COMMAND_PRE_CHARGE 0xD9 //set pre charge
 #define SSD_COMMAND_DEACTIVATE_SCROLL 0x2E
+#define SSD_COMMAND_ACTIVATE_SCROLL 0x2F
+#define SSD_COMMAND_RIGHT_HORIZONTAL_SCROLL 0x26
+#define SSD_COMMAND_LEFT_HORIZONTAL_SCROLL 0x27
+#define SSD_COMMAND_VERTICAL_RIGHT_HORIZONTAL_SCROLL 0x29
+#define SSD_COMMAND_VERTICAL_LEFT_HORIZONTAL_SCROLL 0x2A
+#define SSD_COMMAND_SET_VERTICAL_SCROLL_AREA 0xA3
 #define SSD_COMMAND_SET_COLUMN_ADDRESS 0x21
 #define SSD_COMMAND_SET_PAGE_ADDRESS 0x22
+#define SSD_COMMAND_SET_START_LINE 0x40 //start line 0-63 is in the lower 6 bits
 
 #define SSD_DISPLAY_FLIP_HORIZONTALLY 0x1
 
@@ -35,19 +43,115 @@ if the pixel is being drawn out of currently selected page bounds, it's not draw
 /*
   if the pixel is being drawn out of currently selected page bounds,
   current page buffer is displayed, then cleared and pixel is drawn in bounds of the page.
-  See minimal class drawPixel() function for better understanding.
+  See minimal class pageMiss() function for better understanding.
 */
 #define SSD_MINIMAL_MODE_AUTO 1 
 
+#define SSD_SCROLL_RIGHT 0
+#define SSD_SCROLL_LEFT 1
+
+//time between scroll steps in frames
+#define SSD_SCROLL_FRAMES_2 0x07
+#define SSD_SCROLL_FRAMES_3 0x04
+#define SSD_SCROLL_FRAMES_4 0x05
+#define SSD_SCROLL_FRAMES_5 0x00
+#define SSD_SCROLL_FRAMES_25 0x06
+#define SSD_SCROLL_FRAMES_64 0x01
+#define SSD_SCROLL_FRAMES_128 0x02
+#define SSD_SCROLL_FRAMES_256 0x03
+
 #define SSD_COLOR_BLACK 0
 #define SSD_COLOR_WHITE 1
 #define SSD_COLOR_INVERSE 2
 
-#define START_TRANSMISSION wire->beginTransmission(_addr);
-#define END_TRANSMISSION wire->endTransmission();
-#define SSD_commandByte 0x00
-#define SSD_dataByte 0x40
-#define MAX_I2C_BYTES 30
+#define SSD_MAX_PAGES 8 //ssd1306 GDDRAM has 8 pages of 8 rows
+/*
+  bus bytes a new column window costs in frame diff mode: address + control byte + 6 window command bytes,
+  then address + control byte of the new data transaction. Unchanged gaps up to this size are sent instead of opening a new window
+*/
+#define SSD_DIFF_MERGE_GAP 10
+#define SSD_COMMAND_QUEUE_SIZE 12 //bytes of deferred setting commands
+
+/*
+  native bitmap format for drawBitmap(), laid out like GDDRAM and the framebuffer: width, height,
+  then (height + 7) / 8 pages of width bytes, bit 0 of a byte is the top row of its page.
+  extras/bitmap_converter.py makes it from XBM headers and PBM files
+*/
+#define SSD_BITMAP_HEADER_SIZE 2
+#define SSD_BLIT_CHUNK 16 //page bytes blitted through the stack at a time
+/*
+  compressed bitmap format for drawBitmapRLE(): width, height, then the page bytes of the native format as runs.
+  Code byte below SSD_RLE_ZEROS: (code + 1) literal bytes follow,
+  SSD_RLE_ZEROS to SSD_RLE_REPEAT - 1: (code & 0x3F) + 1 zero bytes,
+  SSD_RLE_REPEAT and above: the next byte is repeated (code & 0x3F) + 1 times
+*/
+#define SSD_RLE_ZEROS 0x80
+#define SSD_RLE_REPEAT 0xC0
+/*
+  fonts are MikroElektronika GLCD Font Creator headers: font type, first and last char, height, a table of
+  char width + 24 bit glyph offset, glyphs stored row by row. Page-major fonts (extras/font_converter.py) have
+  this first byte instead and the same header and table, but glyphs are stored like drawBitmap() images
+*/
+#define SSD_FONT_PAGE_MAJOR 0x50
+#define SSD_MAX_EXPANDED_SCALE 4 //text scales up to this are drawn with bit expansion tables, larger ones as blocks
+#define SSD_STREAM_CHUNK (MAX_I2C_BYTES - 1) //stack bytes a compressed bitmap is decoded to before it's sent
+
+//drawTextBox() flags, one horizontal and one vertical alignment
+#define SSD_ALIGN_LEFT 0x00
+#define SSD_ALIGN_CENTER 0x01
+#define SSD_ALIGN_RIGHT 0x02
+#define SSD_ALIGN_TOP 0x00
+#define SSD_ALIGN_MIDDLE 0x04
+#define SSD_ALIGN_BOTTOM 0x08
+#define SSD_TEXT_ELLIPSIS 0x10 //text that doesn't fit ends the last line with "..."
+#define SSD_TEXT_BOX_LINES 16 //most lines a text box is laid out to, 5 stack bytes each on AVR, 6 on 32-bit boards
+
+/*
+  bus and render statistics, counted into the SSD_Stats the sketch gives setStats(). Off by default, when off nothing is counted.
+  Set it to 1 here or with a build flag (-DSSD_STATS=1), a #define in the sketch doesn't reach the library.
+  The class holds only a pointer and a byte for them either way, so the sketch and the library always agree on its layout
+*/
+#ifndef SSD_STATS
+#define SSD_STATS 0
+#endif
+
+//primitives pixels are counted for, nested calls count for the outer one
+#define SSD_STAT_DRAW_PIXEL 0 //drawPixel() called directly
+#define SSD_STAT_LINE 1
+#define SSD_STAT_RECT 2
+#define SSD_STAT_FILL_RECT 3
+#define SSD_STAT_CIRCLE 4
+#define SSD_STAT_FILL_CIRCLE 5
+#define SSD_STAT_BITMAP 6
+#define SSD_STAT_TEXT 7
+#define SSD_STAT_PRIMITIVES 8
+
+struct SSD_Stats
+{
+  uint32_t transactions, commandBytes, dataBytes;
+  uint16_t busErrors;
+  uint8_t lastBusError; //endTransmission() code of the last failed transaction
+  uint32_t displayMicros; //time spent sending frames
+  uint32_t framesPresented; //pages sent by display() for the minimal class
+  uint32_t pixels[SSD_STAT_PRIMITIVES]; //pixels touched by each primitive
+};
+
+#if SSD_STATS
+
+//primitive owns the pixel count until it returns, unless an outer primitive already does
+struct SSD_StatScope
+{
+  uint8_t &current;
+  bool owner;
+  SSD_StatScope(uint8_t &currentPrimitive, uint8_t primitive) : current(currentPrimitive), owner(currentPrimitive == SSD_STAT_DRAW_PIXEL) { if(owner) current = primitive; }
+  ~SSD_StatScope() { if(owner) current = SSD_STAT_DRAW_PIXEL; }
+};
+#define SSD_STAT_PRIMITIVE(primitive) SSD_StatScope statScope(_statPrimitive, primitive);
+#define SSD_STAT_ADD(field, count) if(_stats != NULL) _stats->field += (count);
+#else
+#define SSD_STAT_PRIMITIVE(primitive)
+#define SSD_STAT_ADD(field, count)
+#endif
 
 #define ROUND(x) ((int)(x+0.5f))
 
@@ -57,11 +161,23 @@ class I2C_ssd1306:public Print {
     virtual size_t write(uint8_t c);
 
     I2C_ssd1306(uint8_t width, uint8_t height, byte ssd1306_address);
-    I2C_ssd1306(){}
+    I2C_ssd1306() : _wireTransport(0) {}
     void begin(TwoWire &I2Cwire);
+    void begin(SSD_Transport &transport);
+    void setMaxI2CBytes(uint8_t maxBytes);
     virtual void display();
+    bool beginDisplay();
+    bool displayStep(uint16_t maxBytes = 0);
+    bool displayFor(uint32_t maxMicros);
+    void present();
+    bool isDisplayBusy() { return _txPage < ((_height + 7) >> 3); }
     virtual void clearDisplay();
-    virtual void drawPixel(int16_t x0, int16_t y0, uint8_t color);
+    //not virtual, the other drawing functions write the buffer through pageRow() instead of calling it
+    void drawPixel(int16_t x0, int16_t y0, uint8_t color);
+    void markDisplayDirty();
+    bool setFrameDiff(bool enable);
+    uint32_t getBytesSaved() { return _bytesSaved; }
+    bool setDoubleBuffer(bool enable);
     void fillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color);
     void fillRectRound(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t cornerRadius, uint8_t color);
     void fillCircle(uint8_t midX, uint8_t midY, uint8_t radius, uint8_t color);
@@ -74,14 +190,35 @@ class I2C_ssd1306:public Print {
     void drawHLine(int16_t x0, int16_t y0, int16_t x1, uint8_t color);
     void drawVLine(int16_t x0, int16_t y0, int16_t y1, uint8_t color);
     void drawXBM(const uint8_t bitmap[], uint8_t width, uint8_t height, uint8_t x, uint8_t y, uint8_t color);
-    void setFont(const unsigned char *fonts);
+    void drawBitmap(const uint8_t bitmap[], uint8_t x, uint8_t y, uint8_t color);
+    void drawBitmapRLE(const uint8_t bitmap[], uint8_t x, uint8_t y, uint8_t color);
+    void streamBitmap(const uint8_t bitmap[], uint8_t x, uint8_t page);
+    void streamBitmapRLE(const uint8_t bitmap[], uint8_t x, uint8_t page);
+    void streamFill(uint8_t value, uint8_t x, uint8_t page, uint8_t width, uint8_t pages);
+    bool setFont(const unsigned char *fonts, bool widthTable = false);
     uint8_t getFontHeight() { return curFont.charHeight * textConf.textScale; };
     void drawText(const char text[], uint8_t color);
+    void drawText(const __FlashStringHelper *text, uint8_t color);
     uint16_t getTextWidth(const char text[]);
+    uint16_t getTextWidth(const __FlashStringHelper *text);
+    void measureText(const char text[], uint16_t &width, uint16_t &height);
+    void measureText(const __FlashStringHelper *text, uint16_t &width, uint16_t &height);
+    uint16_t drawTextBox(const char text[], uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags, uint8_t color);
+    uint16_t drawTextBox(const __FlashStringHelper *text, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags, uint8_t color);
     void setTextOffset(uint8_t offsetX, uint8_t offsetY) { textConf.offsetX = offsetX; textConf.offsetY = offsetY;};
     void setTextScale(uint8_t textScale) { textConf.textScale = textScale;};
     void setTextLineSpacing(uint8_t lineSpacing) { textConf.lineSpacing = lineSpacing; };
-    void setTextLetterSpacing(uint8_t letterSpacing) { textConf.letterSpacing; };
+    void setTextLetterSpacing(uint8_t letterSpacing) { textConf.letterSpacing = letterSpacing; };
+    uint8_t getCharWidth(uint8_t c);
+    bool setGlyphCache(uint16_t bytes);
+    uint32_t getGlyphCacheHits() { return _glyphCacheHits; }
+    uint32_t getGlyphCacheMisses() { return _glyphCacheMisses; }
+    /*
+      while the terminal has scrolled the display start line isn't 0, so the other drawing functions draw
+      in GDDRAM coordinates: row y shows up (y - start line) & 63 rows from the top.
+      Returns false if the buffer doesn't hold the whole display (minimal class), rows are scrolled in the buffer
+    */
+    bool setTerminalMode(bool enable);
     void setCursor(uint8_t column, uint8_t row);
     void setCursorCoord(uint8_t coordX, uint8_t coordY);
     void setCursorColumn(uint8_t column){_cursorX = column;}
@@ -91,18 +228,95 @@ class I2C_ssd1306:public Print {
     void invertDisplay(bool invert);
     void flipVertically (bool flip);
     void setContrast(uint8_t contrastValue);
+    void startScrollHorizontal(uint8_t direction, uint8_t startPage, uint8_t endPage, uint8_t frameInterval);
+    void startScrollDiagonal(uint8_t direction, uint8_t startPage, uint8_t endPage, uint8_t frameInterval, uint8_t verticalOffset);
+    void setVerticalScrollArea(uint8_t fixedTopRows, uint8_t scrollRows);
+    void stopScroll();
+    bool isScrolling() { return _scrolling; }
+    void setDeferredCommands(bool defer);
+    void flushCommands();
+    void setStats(SSD_Stats *stats) { _stats = stats; } //NULL stops counting, nothing is counted unless the library is built with SSD_STATS
+    void resetStats();
     uint8_t getHeight(){return _height;}
     uint8_t getWidth(){return _width;}
     
   protected:
+    I2C_ssd1306(uint8_t width, uint8_t height, byte ssd1306_address, uint8_t *buffer);
     virtual void initialize();
     void sendCommand(uint8_t command);
     void sendCommandList(uint8_t *c_ptr, uint8_t listSize);
+    void sendData(const uint8_t *data, uint8_t count);
+    void sendDataP(const uint8_t *data, uint8_t count);
+    void sendDataFill(uint8_t value, uint8_t count);
+    bool beginStream(uint8_t x, uint8_t page, uint8_t &width, uint8_t &pages);
+    void busResult(uint8_t error, uint8_t transactions = 1);
+    void sendWindowCommands(uint8_t startPage, uint8_t endPage, uint8_t startX, uint8_t endX);
+    void queueCommand(uint8_t command, int16_t argument = -1);
+    uint8_t commandKind(uint8_t command);
+    void startScroll(uint8_t *scrollList, uint8_t listSize);
+    size_t drawChar(uint8_t c, uint8_t color);
+    uint8_t glyphWidth(uint8_t c);
+    void drawText(const char *text, bool inFlash, uint8_t color);
+    void measureText(const char *text, bool inFlash, uint16_t &width, uint16_t &height);
+    uint16_t drawTextBox(const char *text, bool inFlash, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags, uint8_t color);
+    uint16_t layoutLine(const char *text, bool inFlash, uint16_t start, int16_t width, uint16_t &end, uint8_t &lineWidth);
+    const uint8_t *glyphData(uint8_t c);
+    size_t writeTerminal(uint8_t c);
+    void newTerminalRow();
+    bool openWindow();
+    uint8_t sendChunk();
+    /*
+      every drawing path that writes _screenBuffer widens the dirty column bounds of the page it touched,
+      display() sends only these windows. Page is clean when _dirtyStartX > _dirtyEndX
+    */
+    void markDirty(uint8_t page, uint8_t startX, uint8_t endX) {
+      if(startX < _dirtyStartX[page]) _dirtyStartX[page] = startX;
+      if(endX > _dirtyEndX[page]) _dirtyEndX[page] = endX;
+    }
+    void clearDirty(uint8_t page) { _dirtyStartX[page] = 0xFF; _dirtyEndX[page] = 0; }
+    /*
+      buffer row of the page, columns startX to endX of it are going to be drawn to. NULL if the page can't be drawn to.
+      _screenBuffer holds _bufPages pages from _bufPage on, the whole display unless it's the minimal class
+    */
+    uint8_t *pageRow(uint8_t page, uint8_t startX, uint8_t endX) {
+      uint8_t *row = pageRow(page);
+      if(row != NULL) markDirty(page, startX, endX);
+      return row;
+    }
+    /*
+      same without marking anything dirty, for drawing that leaves some columns of its box as they are and marks
+      only the ones it sets bits in. The minimal class sends the marked columns of its cleared page buffer over GDDRAM
+    */
+    uint8_t *pageRow(uint8_t page) {
+      if((uint8_t)(page - _bufPage) >= _bufPages && !pageMiss(page)) return NULL;
+      return _screenBuffer + (uint8_t)(page - _bufPage) * _width;
+    }
+    //page out of the buffer is drawn to, true if the buffer holds it now
+    virtual bool pageMiss(uint8_t) { return false; }
+    void hSpan(uint8_t x0, uint8_t x1, uint8_t y, uint8_t color);
+    void rectSpan(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, uint8_t color);
+    void blitPages(const uint8_t *bitmap, uint8_t width, uint8_t height, uint8_t x0, uint8_t y0, uint8_t color, bool inRAM = false);
+    void drawGlyph(const uint8_t *glyph, uint8_t width, int16_t x, int16_t y, uint8_t color);
+    void drawGlyphExpanded(const uint8_t *glyph, uint8_t width, uint8_t x, uint8_t y, uint8_t color);
+    void resetGlyphCache();
+    uint8_t *cachedGlyph(const uint8_t *glyph, uint8_t width);
+    void decodeGlyph(const uint8_t *glyph, uint8_t width, uint8_t *out);
+    void glyphColumns(const uint8_t *glyph, uint8_t width, uint8_t page, uint8_t cx, uint8_t columns[8]);
+    void xbmColumns(const uint8_t *bitmap, uint8_t widthInBytes, uint8_t height, int16_t bandY, uint8_t byteX, uint8_t columns[8]);
+    void blitColumns(uint8_t *row, uint8_t page, uint8_t x, const uint8_t *columns, uint8_t count, uint8_t color);
     void _swap_uint8_t(uint8_t &a, uint8_t &b);
     void _swap_int16_t(int16_t &a, int16_t &b);
+    //position in a compressed bitmap stream, copied to decode the same bitmap page again
+    struct rleDecoder
+    {
+      const uint8_t *data;
+      uint8_t code, left, value; //run being decoded and its bytes left
+      bool read(uint8_t *out, uint8_t count);
+    };
     struct fontSummary
     {
       uint8_t charHeight;
+      bool pageMajor;
       uint16_t firstCharIndex, lastCharIndex;
     } curFont;
     struct textConfiguration
@@ -115,12 +329,46 @@ class I2C_ssd1306:public Print {
     } textConf;
     
     const unsigned char *_fontFamily;
+    uint8_t *_fontWidths = NULL; //char widths in RAM, see setFont()
+    struct glyphCacheEntry
+    {
+      const uint8_t *glyph; //NULL if the entry is empty
+      uint16_t lastUse;
+    };
+    uint8_t *_glyphCache = NULL; //entries, then their page bytes
+    const unsigned char *_glyphCacheFont;
+    uint16_t _glyphCacheBytes = 0, _glyphCacheEntrySize, _glyphCacheClock;
+    uint8_t _glyphCacheEntries = 0, _glyphCacheScale;
+    uint32_t _glyphCacheHits = 0, _glyphCacheMisses = 0;
     uint8_t _cursorX = 0;
     uint8_t _cursorY = 0;
-    TwoWire *wire;
+    SSD_Transport *_transport = NULL;
+    SSD_WireTransport _wireTransport;
     uint8_t _width, _height;
-    byte _addr;
     uint8_t *_screenBuffer;
+    uint8_t _bufPage = 0, _bufPages;
+    uint8_t _dirtyStartX[SSD_MAX_PAGES], _dirtyEndX[SSD_MAX_PAGES];
+    uint8_t *_shadowBuffer = NULL; //copy of the last frame sent to GDDRAM, only allocated in frame diff mode
+    bool _shadowValid = false;
+    uint32_t _bytesSaved = 0;
+    //snapshot of the dirty windows being sent by displayStep(), transfer is idle when _txPage is past the last page
+    uint8_t _txStartX[SSD_MAX_PAGES], _txEndX[SSD_MAX_PAGES];
+    uint8_t _txPage = SSD_MAX_PAGES, _txEndPage, _txX, _txWindowStartX, _txWindowEndX;
+    bool _txWindowOpen = false;
+    uint8_t *_txBuffer; //buffer being sent, front buffer in double buffer mode
+    uint8_t _txBufPage; //first page _txBuffer holds
+    uint8_t *_frontBuffer = NULL;
+    uint8_t *_allocatedBuffer = NULL; //buffer setDoubleBuffer() allocated, either the front or the back buffer
+    uint8_t _cmdQueue[SSD_COMMAND_QUEUE_SIZE];
+    uint8_t _cmdQueueLength = 0;
+    bool _deferCommands = false;
+    bool _scrolling = false;
+    bool _terminal = false;
+    uint8_t _terminalRowHeight, _startLine = 0;
+    bool _startLineChanged = false; //_startLine is sent at the end of the next transfer
+    uint8_t _txStartLine = 0xFF; //start line sent when the transfer in flight finishes, 0xFF if none
+    SSD_Stats *_stats = NULL;
+    uint8_t _statPrimitive = SSD_STAT_DRAW_PIXEL;
 };
 
 class I2C_ssd1306_minimal : public I2C_ssd1306
@@ -130,14 +378,32 @@ class I2C_ssd1306_minimal : public I2C_ssd1306
     void clearPage();
     void display();
     void clearDisplay();
-    void drawPixel(int16_t x0, int16_t y0, uint8_t color);
-    void setPage(uint8_t page){ if(page < ((_height + 7) / 8)) {_currentPage = page; clearPage();}}
-    uint8_t getPage() {return _currentPage;}
+    void setPage(uint8_t page){ if(page < ((_height + 7) / 8)) {clearDirty(_bufPage); _bufPage = page; clearPage();}}
+    uint8_t getPage() {return _bufPage;}
     void setMinimalMode(uint8_t mode) { _mode = mode;};
+  protected:
+    bool pageMiss(uint8_t page);
   private:
-    uint8_t _currentPage = 0, _startX, _endX;
     uint8_t _mode = SSD_MINIMAL_MODE_AUTO;
 };
 
+/*
+  display with the size known at compile time: the framebuffer is a member array instead of being malloc'd,
+  so a global display shows up in the RAM usage at link time, and a size the controller doesn't have fails to compile.
+  Only the storage is static: drawing uses the same code as the other classes, the row stride is read from _width
+  once per page row drawn
+*/
+template <uint8_t WIDTH, uint8_t HEIGHT>
+class I2C_ssd1306_static : public I2C_ssd1306
+{
+  static_assert(WIDTH > 0 && WIDTH <= 128 && HEIGHT > 0 && HEIGHT <= SSD_MAX_PAGES * 8, "ssd1306 GDDRAM is 128x64");
+  public:
+    static constexpr uint8_t PAGES = (HEIGHT + 7) / 8;
+    static constexpr uint16_t BUFFER_SIZE = WIDTH * PAGES;
+
+    I2C_ssd1306_static(byte ssd1306_address) : I2C_ssd1306(WIDTH, HEIGHT, ssd1306_address, _staticBuffer) {}
+  private:
+    uint8_t _staticBuffer[BUFFER_SIZE];
+};
 
 #endif
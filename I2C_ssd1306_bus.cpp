@@ -0,0 +1,36 @@
+#include "I2C_ssd1306_bus.h"
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#elif defined(ESP8266) || defined(ESP32)
+#include <pgmspace.h>
+#endif
+
+uint8_t SSD_Transport::sendDataP(const uint8_t *data, uint8_t count) {
+  uint8_t stage[SSD_TRANSPORT_STAGE], chunk, error = 0;
+  _lastTransactions = 0;
+  while(count){
+    chunk = count < SSD_TRANSPORT_STAGE ? count : SSD_TRANSPORT_STAGE;
+    _lastTransactions++;
+    memcpy_P(stage, data, chunk);
+    uint8_t result = sendData(stage, chunk);
+    if(result != 0) error = result;
+    data += chunk;
+    count -= chunk;
+  }
+  return error;
+}
+
+uint8_t SSD_Transport::sendDataFill(uint8_t value, uint8_t count) {
+  uint8_t stage[SSD_TRANSPORT_STAGE], chunk, error = 0;
+  memset(stage, value, count < SSD_TRANSPORT_STAGE ? count : SSD_TRANSPORT_STAGE);
+  _lastTransactions = 0;
+  while(count){
+    chunk = count < SSD_TRANSPORT_STAGE ? count : SSD_TRANSPORT_STAGE;
+    _lastTransactions++;
+    uint8_t result = sendData(stage, chunk);
+    if(result != 0) error = result;
+    count -= chunk;
+  }
+  return error;
+}
@@ -0,0 +1,48 @@
+#ifndef I2C_ssd1306_bus_h
+#define I2C_ssd1306_bus_h
+
+//transport interface without Wire and SPI, so transports that don't need them (see I2C_ssd1306_emulator.h) build without them
+#include "Arduino.h"
+
+#define SSD_commandByte 0x00
+#define SSD_dataByte 0x40
+/*
+  bytes of one I2C transaction including the control byte, limited by the Wire buffer of the platform.
+  Can be overridden with a build flag, or per display with setMaxI2CBytes()
+*/
+#ifndef MAX_I2C_BYTES
+  #if defined(ESP32) || defined(ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_RENESAS)
+    #define MAX_I2C_BYTES 128
+  #else
+    #define MAX_I2C_BYTES 30 //AVR Wire buffer is 32 bytes
+  #endif
+#endif
+
+#define SSD_TRANSPORT_STAGE 16 //stack bytes the default sendDataP()/sendDataFill() stage data through
+
+/*
+  Bus the display is connected to. Every send*() call is exactly one bus transaction of at most getMaxChunk() bytes
+  (control byte not counted), so the display class pays one virtual call per transaction, not per byte.
+  Returns 0 on success, otherwise a bus error code (endTransmission() codes for I2C)
+*/
+class SSD_Transport {
+  public:
+    virtual void begin() {}
+    virtual uint8_t sendCommands(const uint8_t *commands, uint8_t count) = 0;
+    virtual uint8_t sendData(const uint8_t *data, uint8_t count) = 0;
+    /*
+      data from PROGMEM and count copies of one byte. By default they are staged through the stack and sent
+      with sendData() in SSD_TRANSPORT_STAGE byte transactions, the transports here override them to send one transaction
+    */
+    virtual uint8_t sendDataP(const uint8_t *data, uint8_t count);
+    virtual uint8_t sendDataFill(uint8_t value, uint8_t count);
+    uint8_t getMaxChunk() { return _maxChunk; }
+    void setMaxChunk(uint8_t maxChunk) { _maxChunk = maxChunk > 0 ? maxChunk : 1; }
+    //transactions the last sendDataP()/sendDataFill() took, more than 1 only for the default ones
+    uint8_t takeTransactionCount() { uint8_t count = _lastTransactions; _lastTransactions = 1; return count; }
+  protected:
+    uint8_t _maxChunk = 255;
+    uint8_t _lastTransactions = 1;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "I2C_ssd1306_emulator.h"
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#elif defined(ESP8266) || defined(ESP32)
+#include <pgmspace.h>
+#endif
+
+SSD_EmulatorTransport::SSD_EmulatorTransport(uint8_t width, uint8_t height, uint8_t maxChunk) {
+  _width = width;
+  _height = height;
+  _maxChunk = maxChunk;
+  reset();
+}
+
+//power on state of the controller
+void SSD_EmulatorTransport::reset() {
+  memset(_gddram, 0, sizeof(_gddram));
+  _commandLength = 0;
+  _addressingMode = 0x02;
+  _columnStart = _column = 0;
+  _columnEnd = SSD_EMULATOR_COLUMNS - 1;
+  _pageStart = _page = 0;
+  _pageEnd = SSD_EMULATOR_PAGES - 1;
+  _startLine = _displayOffset = 0;
+  _muxRatio = 63;
+  _contrast = 0x7F;
+  _segmentRemap = _comInverse = _inverted = _displayOn = _entireDisplayOn = _scrolling = false;
+  resetCounters();
+}
+
+void SSD_EmulatorTransport::resetCounters() {
+  _transactions = _commandBytes = _dataBytes = 0;
+}
+
+uint8_t SSD_EmulatorTransport::sendCommands(const uint8_t *commands, uint8_t count) {
+  _transactions++;
+  _commandBytes += count;
+  //arguments of a command may come in the next transaction
+  while(count--){
+    _command[_commandLength++] = *commands++;
+    if(_commandLength > commandArguments(_command[0])){
+      executeCommand();
+      _commandLength = 0;
+    }
+  }
+  return 0;
+}
+
+uint8_t SSD_EmulatorTransport::sendData(const uint8_t *data, uint8_t count) {
+  _transactions++;
+  _dataBytes += count;
+  while(count--) writeRAM(*data++);
+  return 0;
+}
+
+uint8_t SSD_EmulatorTransport::sendDataP(const uint8_t *data, uint8_t count) {
+  _transactions++;
+  _dataBytes += count;
+  while(count--) writeRAM(pgm_read_byte(data++));
+  return 0;
+}
+
+uint8_t SSD_EmulatorTransport::sendDataFill(uint8_t value, uint8_t count) {
+  _transactions++;
+  _dataBytes += count;
+  while(count--) writeRAM(value);
+  return 0;
+}
+
+//writes the byte at the RAM pointer and advances it like the addressing mode does
+void SSD_EmulatorTransport::writeRAM(uint8_t value) {
+  _gddram[_page][_column] = value;
+  if(_addressingMode == 0x00){ //horizontal
+    if(_column++ >= _columnEnd){
+      _column = _columnStart;
+      _page = _page >= _pageEnd ? _pageStart : _page + 1;
+    }
+  }else if(_addressingMode == 0x01){ //vertical
+    if(_page++ >= _pageEnd){
+      _page = _pageStart;
+      _column = _column >= _columnEnd ? _columnStart : _column + 1;
+    }
+  }else{ //page
+    _column = _column >= SSD_EMULATOR_COLUMNS - 1 ? _columnStart : _column + 1;
+  }
+}
+
+uint8_t SSD_EmulatorTransport::commandArguments(uint8_t command) {
+  switch (command) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22: case 0xA3:
+      return 2;
+    case 0x29: case 0x2A:
+      return 5;
+    case 0x26: case 0x27:
+      return 6;
+    default:
+      return 0;
+  }
+}
+
+void SSD_EmulatorTransport::executeCommand() {
+  uint8_t command = _command[0];
+  if(command <= 0x0F){ //page mode lower column nibble
+    _column = _columnStart = (_column & 0xF0) | command;
+    return;
+  }
+  if(command <= 0x1F){ //page mode higher column nibble
+    _column = _columnStart = ((command & 0x07) << 4) | (_column & 0x0F);
+    return;
+  }
+  if(command >= 0x40 && command <= 0x7F){
+    _startLine = command & 0x3F;
+    return;
+  }
+  if(command >= 0xB0 && command <= 0xB7){
+    _page = command & 0x07;
+    return;
+  }
+  switch (command) {
+    case 0x20: _addressingMode = _command[1] & 0x03; break;
+    case 0x21:
+      _column = _columnStart = _command[1] & 0x7F;
+      _columnEnd = _command[2] & 0x7F;
+      break;
+    case 0x22:
+      _page = _pageStart = _command[1] & 0x07;
+      _pageEnd = _command[2] & 0x07;
+      break;
+    case 0x26: case 0x27: case 0x29: case 0x2A: break; //scroll setup, takes effect with 0x2F
+    case 0x2E: _scrolling = false; break;
+    case 0x2F: _scrolling = true; break;
+    case 0x81: _contrast = _command[1]; break;
+    case 0xA0: case 0xA1: _segmentRemap = command & 1; break;
+    case 0xA4: case 0xA5: _entireDisplayOn = command & 1; break;
+    case 0xA6: case 0xA7: _inverted = command & 1; break;
+    case 0xA8: _muxRatio = _command[1] & 0x3F; break;
+    case 0xAE: case 0xAF: _displayOn = command & 1; break;
+    case 0xC0: _comInverse = false; break;
+    case 0xC8: _comInverse = true; break;
+    case 0xD3: _displayOffset = _command[1] & 0x3F; break;
+    default: break;
+  }
+}
+
+/*
+  pixel as seen on the panel, x and y are in the orientation the library sets up in initialize() (remapped segments,
+  inverse COM scan), so with default settings it matches the framebuffer coordinates
+*/
+bool SSD_EmulatorTransport::getPixel(uint8_t x, uint8_t y) {
+  if(!_displayOn || x >= _width || y >= _height || y > _muxRatio) return false;
+  if(_entireDisplayOn) return true;
+  uint8_t column = _segmentRemap ? x : SSD_EMULATOR_COLUMNS - 1 - x;
+  uint8_t row = _comInverse ? y : _muxRatio - y;
+  row = (row + _startLine + _displayOffset) & 0x3F;
+  return getRAMPixel(column, row) != _inverted;
+}
+
+void SSD_EmulatorTransport::printAscii(Print &out) {
+  for(uint8_t y = 0; y < _height; y++){
+    for(uint8_t x = 0; x < _width; x++) out.write(getPixel(x, y) ? '#' : '.');
+    out.write('\n');
+  }
+}
+
+//plain (ASCII) PGM image of the panel
+void SSD_EmulatorTransport::printPGM(Print &out) {
+  out.print("P2\n");
+  out.print(_width);
+  out.print(' ');
+  out.print(_height);
+  out.print("\n255\n");
+  for(uint8_t y = 0; y < _height; y++){
+    for(uint8_t x = 0; x < _width; x++){
+      out.print(getPixel(x, y) ? 255 : 0);
+      out.write(x == _width - 1 ? '\n' : ' ');
+    }
+  }
+}
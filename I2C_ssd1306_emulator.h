@@ -0,0 +1,54 @@
+#ifndef I2C_ssd1306_emulator_h
+#define I2C_ssd1306_emulator_h
+
+#include "I2C_ssd1306_bus.h"
+#include "Print.h"
+
+#define SSD_EMULATOR_COLUMNS 128
+#define SSD_EMULATOR_PAGES 8
+
+/*
+  transport that decodes the command and data stream like the ssd1306 does and keeps the GDDRAM in memory,
+  so rendering and bus optimizations can be checked pixel by pixel and measured in bytes without a display.
+  Emulates addressing modes, column/page windows, start line, display offset, multiplex ratio, remap, inversion,
+  display on/off and entire display on. Scroll commands are decoded and the scroll state is kept, but the content isn't animated.
+  Uses 1KB of RAM for the GDDRAM
+*/
+class SSD_EmulatorTransport : public SSD_Transport {
+  public:
+    SSD_EmulatorTransport(uint8_t width, uint8_t height, uint8_t maxChunk = MAX_I2C_BYTES - 1);
+    uint8_t sendCommands(const uint8_t *commands, uint8_t count);
+    uint8_t sendData(const uint8_t *data, uint8_t count);
+    uint8_t sendDataP(const uint8_t *data, uint8_t count);
+    uint8_t sendDataFill(uint8_t value, uint8_t count);
+    void reset();
+    void resetCounters();
+
+    bool getPixel(uint8_t x, uint8_t y);
+    bool getRAMPixel(uint8_t column, uint8_t row) { return (_gddram[(row >> 3) & 7][column & 127] >> (row & 7)) & 1; }
+    uint8_t getRAMByte(uint8_t page, uint8_t column) { return _gddram[page & 7][column & 127]; }
+    void printAscii(Print &out);
+    void printPGM(Print &out);
+
+    uint32_t getTransactions() { return _transactions; }
+    uint32_t getCommandBytes() { return _commandBytes; }
+    uint32_t getDataBytes() { return _dataBytes; }
+    uint8_t getStartLine() { return _startLine; }
+    uint8_t getContrast() { return _contrast; }
+    bool isDisplayOn() { return _displayOn; }
+    bool isInverted() { return _inverted; }
+    bool isScrolling() { return _scrolling; }
+  private:
+    void writeRAM(uint8_t value);
+    void executeCommand();
+    uint8_t commandArguments(uint8_t command);
+    uint8_t _gddram[SSD_EMULATOR_PAGES][SSD_EMULATOR_COLUMNS];
+    uint8_t _width, _height;
+    uint8_t _command[7], _commandLength;
+    uint8_t _addressingMode, _columnStart, _columnEnd, _pageStart, _pageEnd, _column, _page;
+    uint8_t _startLine, _displayOffset, _muxRatio, _contrast;
+    bool _segmentRemap, _comInverse, _inverted, _displayOn, _entireDisplayOn, _scrolling;
+    uint32_t _transactions, _commandBytes, _dataBytes;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "I2C_ssd1306_transport.h"
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#elif defined(ESP8266) || defined(ESP32)
+#include <pgmspace.h>
+#endif
+
+uint8_t SSD_WireTransport::send(uint8_t controlByte, const uint8_t *bytes, uint8_t count) {
+  START_TRANSMISSION
+  wire->write(controlByte);
+  wire->write(bytes, count);
+  return END_TRANSMISSION
+}
+
+uint8_t SSD_WireTransport::sendDataP(const uint8_t *data, uint8_t count) {
+  START_TRANSMISSION
+  wire->write(SSD_dataByte);
+  while(count--) wire->write(pgm_read_byte(data++));
+  return END_TRANSMISSION
+}
+
+uint8_t SSD_WireTransport::sendDataFill(uint8_t value, uint8_t count) {
+  START_TRANSMISSION
+  wire->write(SSD_dataByte);
+  while(count--) wire->write(value);
+  return END_TRANSMISSION
+}
+
+SSD_SPITransport::SSD_SPITransport(SPIClass &spi, uint8_t csPin, uint8_t dcPin, uint8_t resetPin, uint32_t clock)
+  : _settings(clock, MSBFIRST, SPI_MODE0) {
+  _spi = &spi;
+  _csPin = csPin;
+  _dcPin = dcPin;
+  _resetPin = resetPin;
+}
+
+void SSD_SPITransport::begin() {
+  pinMode(_csPin, OUTPUT);
+  pinMode(_dcPin, OUTPUT);
+  digitalWrite(_csPin, HIGH);
+  if(_resetPin != SSD_SPI_NO_PIN){
+    pinMode(_resetPin, OUTPUT);
+    digitalWrite(_resetPin, LOW);
+    delay(1); //reset pulse has to be at least 3us
+    digitalWrite(_resetPin, HIGH);
+    delay(1);
+  }
+  _spi->begin();
+}
+
+void SSD_SPITransport::select(uint8_t dcLevel) {
+  _spi->beginTransaction(_settings);
+  digitalWrite(_dcPin, dcLevel);
+  digitalWrite(_csPin, LOW);
+}
+
+void SSD_SPITransport::deselect() {
+  digitalWrite(_csPin, HIGH);
+  _spi->endTransaction();
+}
+
+uint8_t SSD_SPITransport::send(uint8_t dcLevel, const uint8_t *bytes, uint8_t count) {
+  select(dcLevel);
+  while(count--) _spi->transfer(*bytes++);
+  deselect();
+  return 0;
+}
+
+uint8_t SSD_SPITransport::sendDataP(const uint8_t *data, uint8_t count) {
+  select(HIGH);
+  while(count--) _spi->transfer(pgm_read_byte(data++));
+  deselect();
+  return 0;
+}
+
+uint8_t SSD_SPITransport::sendDataFill(uint8_t value, uint8_t count) {
+  select(HIGH);
+  while(count--) _spi->transfer(value);
+  deselect();
+  return 0;
+}
+
+SSD_RecorderTransport::SSD_RecorderTransport(uint8_t *log, uint16_t logSize, uint8_t maxChunk) {
+  _log = log;
+  _logSize = logSize;
+  _maxChunk = maxChunk;
+  reset();
+}
+
+void SSD_RecorderTransport::reset() {
+  _logLength = 0;
+  _transactions = _commandBytes = _dataBytes = 0;
+}
+
+uint8_t SSD_RecorderTransport::sendCommands(const uint8_t *commands, uint8_t count) {
+  uint8_t *log = record(SSD_commandByte, count);
+  if(log != NULL) memcpy(log, commands, count);
+  return 0;
+}
+
+uint8_t SSD_RecorderTransport::sendData(const uint8_t *data, uint8_t count) {
+  uint8_t *log = record(SSD_dataByte, count);
+  if(log != NULL) memcpy(log, data, count);
+  return 0;
+}
+
+uint8_t SSD_RecorderTransport::sendDataP(const uint8_t *data, uint8_t count) {
+  uint8_t *log = record(SSD_dataByte, count);
+  if(log != NULL) memcpy_P(log, data, count);
+  return 0;
+}
+
+uint8_t SSD_RecorderTransport::sendDataFill(uint8_t value, uint8_t count) {
+  uint8_t *log = record(SSD_dataByte, count);
+  if(log != NULL) memset(log, value, count);
+  return 0;
+}
+
+//counts the transaction, returns where its bytes go in the log or NULL if they aren't logged
+uint8_t *SSD_RecorderTransport::record(uint8_t controlByte, uint8_t count) {
+  _transactions++;
+  if(controlByte == SSD_commandByte) _commandBytes += count;
+  else _dataBytes += count;
+  if(_log == NULL || _logLength + count + 1 > _logSize) return NULL;
+  _log[_logLength++] = controlByte;
+  _logLength += count;
+  return _log + _logLength - count;
+}
@@ -0,0 +1,73 @@
+#ifndef I2C_ssd1306_transport_h
+#define I2C_ssd1306_transport_h
+
+#include "I2C_ssd1306_bus.h"
+#include <Wire.h>
+#include <SPI.h>
+
+#define SSD_SPI_NO_PIN 0xFF
+#define SSD_SPI_DEFAULT_CLOCK 8000000 //ssd1306 serial clock cycle is at least 100ns
+
+#define START_TRANSMISSION wire->beginTransmission(_addr);
+#define END_TRANSMISSION wire->endTransmission();
+
+class SSD_WireTransport : public SSD_Transport {
+  public:
+    SSD_WireTransport(byte ssd1306_address) { _addr = ssd1306_address; _maxChunk = MAX_I2C_BYTES - 1; }
+    void setWire(TwoWire &I2Cwire) { wire = &I2Cwire; }
+    uint8_t sendCommands(const uint8_t *commands, uint8_t count) { return send(SSD_commandByte, commands, count); }
+    uint8_t sendData(const uint8_t *data, uint8_t count) { return send(SSD_dataByte, data, count); }
+    uint8_t sendDataP(const uint8_t *data, uint8_t count);
+    uint8_t sendDataFill(uint8_t value, uint8_t count);
+  private:
+    uint8_t send(uint8_t controlByte, const uint8_t *bytes, uint8_t count);
+    TwoWire *wire;
+    byte _addr;
+};
+
+/*
+  4-wire SPI: D/C pin selects command or data, no control byte is sent.
+  Reset pin is optional, pass SSD_SPI_NO_PIN if it's tied to the MCU reset
+*/
+class SSD_SPITransport : public SSD_Transport {
+  public:
+    SSD_SPITransport(SPIClass &spi, uint8_t csPin, uint8_t dcPin, uint8_t resetPin = SSD_SPI_NO_PIN, uint32_t clock = SSD_SPI_DEFAULT_CLOCK);
+    void begin();
+    uint8_t sendCommands(const uint8_t *commands, uint8_t count) { return send(LOW, commands, count); }
+    uint8_t sendData(const uint8_t *data, uint8_t count) { return send(HIGH, data, count); }
+    uint8_t sendDataP(const uint8_t *data, uint8_t count);
+    uint8_t sendDataFill(uint8_t value, uint8_t count);
+  private:
+    uint8_t send(uint8_t dcLevel, const uint8_t *bytes, uint8_t count);
+    void select(uint8_t dcLevel);
+    void deselect();
+    SPIClass *_spi;
+    SPISettings _settings;
+    uint8_t _csPin, _dcPin, _resetPin;
+};
+
+/*
+  keeps the bus traffic in memory instead of sending it: counts transactions and bytes and,
+  if a log buffer is given, stores every transaction as its control byte (SSD_commandByte/SSD_dataByte) followed by its bytes.
+  Logging stops when the buffer is full
+*/
+class SSD_RecorderTransport : public SSD_Transport {
+  public:
+    SSD_RecorderTransport(uint8_t *log = NULL, uint16_t logSize = 0, uint8_t maxChunk = MAX_I2C_BYTES - 1);
+    uint8_t sendCommands(const uint8_t *commands, uint8_t count);
+    uint8_t sendData(const uint8_t *data, uint8_t count);
+    uint8_t sendDataP(const uint8_t *data, uint8_t count);
+    uint8_t sendDataFill(uint8_t value, uint8_t count);
+    void reset();
+    uint32_t getTransactions() { return _transactions; }
+    uint32_t getCommandBytes() { return _commandBytes; }
+    uint32_t getDataBytes() { return _dataBytes; }
+    uint16_t getLogLength() { return _logLength; }
+  private:
+    uint8_t *record(uint8_t controlByte, uint8_t count);
+    uint8_t *_log;
+    uint16_t _logSize, _logLength;
+    uint32_t _transactions, _commandBytes, _dataBytes;
+};
+
+#endif
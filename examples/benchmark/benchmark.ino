@@ -0,0 +1,135 @@
+#include <Arduino.h>
+#include <I2C_ssd1306.h> //I2C SSD1306 lite library
+#include <Fonts/Picopixel5x6.h> //Fonts that will be used
+#include <splash128x64.h> //splash screen image file. Image is in XBM format
+
+#define SCREEN_WIDTH 128 //Width of the screen
+#define SCREEN_HEIGHT 64 //Height of the screen
+#ifndef ITERATIONS
+#define ITERATIONS 50 //how many times every case is drawn, at most 255
+#endif
+
+/*
+  Times the drawing primitives and counts the bus traffic of display() and I2C_ssd1306_minimal::display().
+  Results are printed to Serial as CSV, one line per case, lines starting with # describe the columns:
+    draw,<primitive>,<size or text scale>,<iterations>,<microseconds per call>
+    transfer,<case>,<transactions>,<command bytes>,<data bytes>,<microseconds>
+  Nothing is sent to a screen, recorder transports only count the traffic, so it runs on a board without a display
+*/
+
+SSD_RecorderTransport recorder;
+SSD_RecorderTransport minimalRecorder;
+I2C_ssd1306 oled(SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+I2C_ssd1306_minimal oledMinimal(SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+
+uint32_t benchStart;
+
+#define BENCH(primitive, size, drawCall) \
+  oled.clearDisplay(); \
+  benchStart = micros(); \
+  for(uint8_t i = 0; i < ITERATIONS; i++){ drawCall; } \
+  printDrawResult(primitive, size, micros() - benchStart);
+
+void printDrawResult(const char primitive[], uint8_t size, uint32_t totalMicros);
+void printTransferResult(const char name[], SSD_RecorderTransport &transport, uint32_t totalMicros);
+void benchDraw();
+void benchTransfer();
+
+void setup() {
+  Serial.begin(115200);
+  oled.begin(recorder);
+  oled.setFont(Picopixel5x6);
+  oledMinimal.begin(minimalRecorder);
+  oledMinimal.setFont(Picopixel5x6);
+
+  Serial.println("#draw,primitive,param,iterations,us_per_call");
+  Serial.println("#transfer,case,transactions,command_bytes,data_bytes,us");
+  benchDraw();
+  benchTransfer();
+}
+
+void loop() {
+}
+
+void benchDraw(){
+  const uint8_t sizes[] = {8, 32, 63};
+  for(uint8_t s = 0; s < sizeof(sizes); s++){
+    uint8_t size = sizes[s];
+    BENCH("drawPixel", size, for(uint8_t j = 0; j < size; j++) oled.drawPixel(j, j & 63, SSD_COLOR_WHITE))
+    BENCH("drawHLine", size, oled.drawHLine(0, i & 63, size - 1, SSD_COLOR_WHITE))
+    BENCH("drawVLine", size, oled.drawVLine(i, 0, size - 1, SSD_COLOR_WHITE))
+    BENCH("drawLine", size, oled.drawLine(0, 0, size * 2 - 1, size - 1, SSD_COLOR_WHITE))
+    BENCH("fillRect", size, oled.fillRect(0, 0, size * 2, size, SSD_COLOR_INVERSE))
+    BENCH("fillCircle", size, oled.fillCircle(64, 32, size / 2, SSD_COLOR_INVERSE))
+    BENCH("fillRectRound", size, oled.fillRectRound(0, 0, size * 2, size, size / 4, SSD_COLOR_INVERSE))
+  }
+  BENCH("drawXBM", splash128x64_height, oled.drawXBM(splash128x64_bits, splash128x64_width, splash128x64_height, 26, 8, SSD_COLOR_INVERSE))
+  for(uint8_t scale = 1; scale <= 4; scale++){
+    oled.setTextScale(scale);
+    BENCH("drawText", scale, oled.setCursor(0, 0); oled.drawText("0123456789", SSD_COLOR_WHITE))
+  }
+  oled.setTextScale(1);
+}
+
+void benchTransfer(){
+  //whole frame
+  oled.clearDisplay();
+  recorder.reset();
+  benchStart = micros();
+  oled.display();
+  printTransferResult("fullFrame", recorder, micros() - benchStart);
+
+  //small change, only dirty columns are sent
+  oled.fillRect(10, 10, 12, 6, SSD_COLOR_WHITE);
+  recorder.reset();
+  benchStart = micros();
+  oled.display();
+  printTransferResult("smallChange", recorder, micros() - benchStart);
+
+  //whole frame redrawn with the same content, frame diff sends nothing
+  if(oled.setFrameDiff(true)){
+    oled.display();
+    oled.clearDisplay();
+    oled.fillRect(10, 10, 12, 6, SSD_COLOR_WHITE);
+    recorder.reset();
+    benchStart = micros();
+    oled.display();
+    printTransferResult("redrawFrameDiff", recorder, micros() - benchStart);
+    oled.setFrameDiff(false);
+  }
+
+  //minimal class, one page at a time
+  oledMinimal.setMinimalMode(SSD_MINIMAL_MODE_MANUAL);
+  minimalRecorder.reset();
+  benchStart = micros();
+  for(uint8_t page = 0; page < (SCREEN_HEIGHT + 7) / 8; page++){
+    oledMinimal.setPage(page);
+    oledMinimal.fillRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, SSD_COLOR_WHITE);
+    oledMinimal.display();
+  }
+  printTransferResult("minimalFullFrame", minimalRecorder, micros() - benchStart);
+}
+
+void printDrawResult(const char primitive[], uint8_t size, uint32_t totalMicros){
+  Serial.print("draw,");
+  Serial.print(primitive);
+  Serial.print(',');
+  Serial.print(size);
+  Serial.print(',');
+  Serial.print(ITERATIONS);
+  Serial.print(',');
+  Serial.println((float)totalMicros / ITERATIONS);
+}
+
+void printTransferResult(const char name[], SSD_RecorderTransport &transport, uint32_t totalMicros){
+  Serial.print("transfer,");
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(transport.getTransactions());
+  Serial.print(',');
+  Serial.print(transport.getCommandBytes());
+  Serial.print(',');
+  Serial.print(transport.getDataBytes());
+  Serial.print(',');
+  Serial.println(totalMicros);
+}
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include <I2C_ssd1306.h> //I2C SSD1306 lite library
+#include <I2C_ssd1306_emulator.h> //emulated display, no screen needed
+#include <Fonts/Picopixel5x6.h> //Fonts that will be used
+
+#define SCREEN_WIDTH 128 //Width of the screen
+#define SCREEN_HEIGHT 64 //Height of the screen
+
+//decodes everything the library sends into an emulated GDDRAM
+SSD_EmulatorTransport emulator(SCREEN_WIDTH, SCREEN_HEIGHT);
+I2C_ssd1306 oled(SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+
+void printBusUsage(const char name[]);
+
+void setup() {
+  Serial.begin(115200);
+  oled.begin(emulator);
+  oled.setFont(Picopixel5x6);
+
+  //first frame
+  emulator.resetCounters();
+  oled.clearDisplay();
+  oled.drawRectRound(0, 0, oled.getWidth(), oled.getHeight(), 6, SSD_COLOR_WHITE);
+  oled.setCursorCoord(10, 10);
+  oled.print("Emulated display");
+  oled.fillCircle(oled.getWidth() / 2, 40, 12, SSD_COLOR_WHITE);
+  oled.display();
+  printBusUsage("first frame");
+
+  //only one number changes, only the changed columns are sent
+  emulator.resetCounters();
+  oled.fillRect(10, 50, 20, 6, SSD_COLOR_BLACK);
+  oled.setCursorCoord(10, 50);
+  oled.print(123);
+  oled.display();
+  printBusUsage("number update");
+
+  //what the panel shows
+  emulator.printAscii(Serial);
+}
+
+void loop() {
+}
+
+//prints bus traffic since the last resetCounters()
+void printBusUsage(const char name[]){
+  Serial.print(name);
+  Serial.print(": transactions ");
+  Serial.print(emulator.getTransactions());
+  Serial.print(", command bytes ");
+  Serial.print(emulator.getCommandBytes());
+  Serial.print(", data bytes ");
+  Serial.println(emulator.getDataBytes());
+}
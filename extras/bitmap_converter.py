@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Converts XBM headers (like splash128x64.h) and PBM files (P1 or P4) into the
+page-major bitmap format drawn by I2C_ssd1306::drawBitmap():
+width, height, then (height + 7) / 8 pages of width bytes, bit 0 is the top row of the page.
+With --rle the page bytes are run-length encoded for drawBitmapRLE().
+
+  python3 bitmap_converter.py splash128x64.h > splash128x64_pages.h
+  python3 bitmap_converter.py logo.pbm --name logo -o logo.h
+  python3 bitmap_converter.py splash128x64.h --rle > splash128x64_rle.h
+"""
+import argparse
+import os
+import re
+import sys
+
+
+def read_xbm(text):
+    width = re.search(r"#define\s+\w*?_?width\s+(\d+)", text)
+    height = re.search(r"#define\s+\w*?_?height\s+(\d+)", text)
+    if not width or not height:
+        raise ValueError("XBM header has no _width/_height defines")
+    width, height = int(width.group(1)), int(height.group(1))
+    data = text[text.index("{") + 1:text.rindex("}")]
+    values = [int(v, 0) for v in re.findall(r"0[xX][0-9a-fA-F]+|\d+", data)]
+    row_bytes = (width + 7) // 8
+    if len(values) < row_bytes * height:
+        raise ValueError("XBM data is shorter than width x height")
+    pixels = [[(values[y * row_bytes + (x >> 3)] >> (x & 7)) & 1 for x in range(width)] for y in range(height)]
+    return width, height, pixels
+
+
+def pbm_tokens(data):
+    # header fields separated by whitespace, comments start with #
+    pos, tokens = 0, []
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            while data[pos:pos + 1] not in (b"\n", b""):
+                pos += 1
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    return tokens, pos + 1
+
+
+def read_pbm(data):
+    (magic, width, height), pos = pbm_tokens(data)
+    width, height = int(width), int(height)
+    if magic == b"P4":
+        row_bytes = (width + 7) // 8
+        raw = data[pos:pos + row_bytes * height]
+        pixels = [[(raw[y * row_bytes + (x >> 3)] >> (7 - (x & 7))) & 1 for x in range(width)] for y in range(height)]
+    elif magic == b"P1":
+        bits = [int(b) for b in re.findall(rb"[01]", re.sub(rb"#[^\n]*", b"", data[pos:]))]
+        pixels = [bits[y * width:(y + 1) * width] for y in range(height)]
+    else:
+        raise ValueError("only P1 and P4 PBM files are supported")
+    return width, height, pixels
+
+
+def to_pages(width, height, pixels):
+    out = []
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and pixels[y][x]:
+                    byte |= 1 << bit
+            out.append(byte)
+    return out
+
+
+RLE_ZEROS = 0x80
+RLE_REPEAT = 0xC0
+RLE_MAX_RUN = 64
+RLE_MAX_LITERAL = 128
+
+
+def run_length(data, i, limit):
+    n = 1
+    while i + n < len(data) and n < limit and data[i + n] == data[i]:
+        n += 1
+    return n
+
+
+def rle_encode(data):
+    """codes match SSD_RLE_ZEROS and SSD_RLE_REPEAT in I2C_ssd1306.h"""
+    out, literal, i = [], [], 0
+
+    def flush():
+        if literal:
+            out.append(len(literal) - 1)
+            out.extend(literal)
+            del literal[:]
+
+    while i < len(data):
+        run = run_length(data, i, RLE_MAX_RUN)
+        # a run beats a literal once it saves a byte: 2 zeros cost 1 code byte, 3 repeats cost code + value
+        if data[i] == 0 and run >= 2:
+            flush()
+            out.append(RLE_ZEROS | (run - 1))
+        elif data[i] != 0 and run >= 3:
+            flush()
+            out.extend((RLE_REPEAT | (run - 1), data[i]))
+        else:
+            run = 1
+            literal.append(data[i])
+            if len(literal) == RLE_MAX_LITERAL:
+                flush()
+        i += run
+    flush()
+    return out
+
+
+def write_header(name, width, height, data, out, rle=False):
+    out.write("//%dx%d, %s\n" % (width, height, "run-length encoded, see drawBitmapRLE()" if rle else "page-major, see drawBitmap()"))
+    out.write("const uint8_t %s[] PROGMEM = {\n  %d, %d, //width, height" % (name, width, height))
+    for i, byte in enumerate(data):
+        if i % 16 == 0:
+            out.write("\n  ")
+        out.write("0x%02X, " % byte)
+    out.write("\n};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="XBM header (.h/.xbm) or PBM file")
+    parser.add_argument("--name", help="array name, by default taken from the input")
+    parser.add_argument("-o", "--output", help="output header, stdout by default")
+    parser.add_argument("--rle", action="store_true", help="run-length encode the page bytes for drawBitmapRLE()")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    if data[:2] in (b"P1", b"P4"):
+        width, height, pixels = read_pbm(data)
+        name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.input))[0])
+        name += "_rle" if args.rle else ""
+    else:
+        text = data.decode("latin-1")
+        width, height, pixels = read_xbm(text)
+        bits = re.search(r"(\w+?)(_bits)?\s*\[\s*\]", text)
+        name = bits.group(1) if bits else re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.input))[0])
+        name += "_rle" if args.rle else "_pages"
+    if width > 255 or height > 255:
+        raise SystemExit("bitmap is larger than 255x255")
+
+    data = to_pages(width, height, pixels)
+    if args.rle:
+        encoded = rle_encode(data)
+        sys.stderr.write("%d page bytes, %d encoded\n" % (len(data), len(encoded)))
+        data = encoded
+    out = open(args.output, "w") if args.output else sys.stdout
+    write_header(args.name or name, width, height, data, out, args.rle)
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
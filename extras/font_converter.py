@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+Compiles fonts into the page-major font format of I2C_ssd1306 (SSD_FONT_PAGE_MAJOR), whose glyphs are
+stored like the framebuffer and drawn a byte per column instead of a pixel at a time.
+
+Sources:
+  MikroElektronika GLCD Font Creator headers, like the ones in Fonts/
+  BDF bitmap fonts
+  TTF/OTF fonts rendered at --size pixels, needs Pillow
+
+  python3 font_converter.py ../Fonts/Roboto10x12.h > Roboto10x12_pages.h
+  python3 font_converter.py terminus.bdf --name Terminus8x16 -o Terminus8x16.h
+  python3 font_converter.py DejaVuSans.ttf --size 16 --first 32 --last 126 > DejaVu16.h
+
+Format, same header and char table as MikroElektronika fonts:
+  0x50, 0x00, first char (2 bytes LE), last char (2 bytes LE), height, 0x00,
+  per char: width, glyph offset from the start of the font (3 bytes LE),
+  glyphs: (height + 7) / 8 pages of width bytes, bit 0 is the top row of the page
+"""
+import argparse
+import os
+import re
+import sys
+
+PAGE_MAJOR = 0x50
+HEADER_SIZE = 8
+
+
+class Font:
+    def __init__(self, name, height, first, glyphs):
+        self.name = name
+        self.height = height
+        self.first = first
+        self.glyphs = glyphs  # list of (width, rows), rows[y][x] is 0 or 1
+
+
+def c_array(text):
+    name = re.search(r"(\w+)\s*\[\s*\]", text)
+    data = text[text.index("{") + 1:text.rindex("}")]
+    data = re.sub(r"//[^\n]*", "", data)
+    return name.group(1) if name else None, [int(v, 0) for v in re.findall(r"0[xX][0-9a-fA-F]+|\d+", data)]
+
+
+def read_mikroe(text):
+    name, data = c_array(text)
+    if data[0] == PAGE_MAJOR:
+        raise ValueError("font is already page-major")
+    first, last, height = data[2] | data[3] << 8, data[4] | data[5] << 8, data[6]
+    glyphs = []
+    for i in range(last - first + 1):
+        entry = HEADER_SIZE + i * 4
+        width, offset = data[entry], data[entry + 1] | data[entry + 2] << 8 | data[entry + 3] << 16
+        row_bytes = (width + 7) // 8
+        rows = [[(data[offset + y * row_bytes + (x >> 3)] >> (x & 7)) & 1 for x in range(width)] for y in range(height)]
+        glyphs.append((width, rows))
+    return Font(name, height, first, glyphs)
+
+
+def read_bdf(text, first, last):
+    ascent = int(re.search(r"^FONT_ASCENT\s+(-?\d+)", text, re.M).group(1))
+    descent = int(re.search(r"^FONT_DESCENT\s+(-?\d+)", text, re.M).group(1))
+    height = ascent + descent
+    chars = {}
+    for block in re.findall(r"STARTCHAR.*?ENDCHAR", text, re.S):
+        code = int(re.search(r"ENCODING\s+(-?\d+)", block).group(1))
+        if code < first or code > last:
+            continue
+        advance = int(re.search(r"DWIDTH\s+(-?\d+)", block).group(1))
+        w, h, xoff, yoff = [int(v) for v in re.search(r"BBX\s+(-?\d+)\s+(-?\d+)\s+(-?\d+)\s+(-?\d+)", block).groups()]
+        lines = block[block.index("BITMAP") + 6:block.index("ENDCHAR")].split()
+        rows = [[0] * advance for _ in range(height)]
+        top = ascent - (yoff + h)
+        for r, line in enumerate(lines[:h]):
+            bits = int(line, 16)
+            length = len(line) * 4
+            for c in range(w):
+                x, y = xoff + c, top + r
+                if (bits >> (length - 1 - c)) & 1 and 0 <= x < advance and 0 <= y < height:
+                    rows[y][x] = 1
+        chars[code] = (advance, rows)
+    return Font(None, height, first, [chars.get(c, (0, [[] for _ in range(height)])) for c in range(first, last + 1)])
+
+
+def read_ttf(path, size, first, last):
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        raise SystemExit("TTF fonts need Pillow: pip install pillow")
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    glyphs = []
+    for code in range(first, last + 1):
+        advance = int(round(font.getlength(chr(code))))
+        image = Image.new("1", (max(advance, 1), height), 0)
+        ImageDraw.Draw(image).text((0, 0), chr(code), font=font, fill=1)
+        rows = [[1 if image.getpixel((x, y)) else 0 for x in range(advance)] for y in range(height)]
+        glyphs.append((advance, rows))
+    return Font(None, height, first, glyphs)
+
+
+def compile_font(font):
+    last = font.first + len(font.glyphs) - 1
+    pages = (font.height + 7) // 8
+    out = [PAGE_MAJOR, 0x00, font.first & 0xFF, font.first >> 8, last & 0xFF, last >> 8, font.height, 0x00]
+    table, data = [], []
+    offset = HEADER_SIZE + 4 * len(font.glyphs)
+    for width, rows in font.glyphs:
+        if width > 255:
+            raise SystemExit("glyph wider than 255 columns")
+        table.append([width, offset & 0xFF, (offset >> 8) & 0xFF, offset >> 16])
+        glyph = []
+        for page in range(pages):
+            for x in range(width):
+                byte = 0
+                for bit in range(8):
+                    y = page * 8 + bit
+                    if y < font.height and rows[y][x]:
+                        byte |= 1 << bit
+                glyph.append(byte)
+        data.append(glyph)
+        offset += len(glyph)
+    return out, table, data
+
+
+def write_header(name, source, font, out):
+    header, table, data = compile_font(font)
+    out.write("//Page-major font compiled by extras/font_converter.py from %s\n" % os.path.basename(source))
+    out.write("//Height %d, chars %d to %d\n\n" % (font.height, font.first, font.first + len(font.glyphs) - 1))
+    out.write("const unsigned char %s[] PROGMEM = {\n" % name)
+    out.write("   " + ",".join("0x%02X" % b for b in header) + ",\n")
+    for entry in table:
+        out.write("   " + ",".join("0x%02X" % b for b in entry) + ",\n")
+    for i, glyph in enumerate(data):
+        if glyph:
+            out.write("   " + ",".join("0x%02X" % b for b in glyph) + ",")
+        else:
+            out.write("  ")
+        out.write("           // Code for char num %d\n" % (font.first + i))
+    out.write("        };\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="MikroElektronika header (.h), BDF or TTF/OTF font")
+    parser.add_argument("--name", help="array name, by default taken from the input")
+    parser.add_argument("-o", "--output", help="output header, stdout by default")
+    parser.add_argument("--size", type=int, help="pixel size TTF/OTF fonts are rendered at")
+    parser.add_argument("--first", type=int, default=32, help="first char of BDF and TTF fonts")
+    parser.add_argument("--last", type=int, default=127, help="last char of BDF and TTF fonts")
+    args = parser.parse_args()
+
+    base = re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.input))[0])
+    extension = os.path.splitext(args.input)[1].lower()
+    if extension in (".ttf", ".otf"):
+        if not args.size:
+            raise SystemExit("--size is needed for TTF/OTF fonts")
+        font = read_ttf(args.input, args.size, args.first, args.last)
+        name = "%s%d" % (base, args.size)
+    else:
+        with open(args.input, encoding="latin-1") as f:
+            text = f.read()
+        if text.lstrip().startswith("STARTFONT"):
+            font = read_bdf(text, args.first, args.last)
+            name = base
+        else:
+            font = read_mikroe(text)
+            name = (font.name or base) + "_pages"
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    write_header(args.name or name, args.input, font, out)
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,8 @@
+//runs the benchmark sketch on the development machine, more iterations as micros() ticks are long compared to the calls
+#define ITERATIONS 250
+#include "../../examples/benchmark/benchmark.ino"
+
+int main() {
+  setup();
+  return 0;
+}
@@ -0,0 +1,591 @@
+/*
+  draws into the display classes and checks the emulated GDDRAM pixel by pixel: against known shapes, against the framebuffer,
+  the frame diff, double buffer and stepped transfer paths against a plain display(), and the span, bitmap and glyph
+  kernels against the same drawing done with drawPixel() into a second display
+*/
+#include "I2C_ssd1306.h"
+#include "I2C_ssd1306_emulator.h"
+#include "Fonts/Picopixel5x6.h"
+#include "Fonts/Roboto10x12.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition) do { if(!(condition)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while(0)
+
+//exposes the framebuffer
+class TestDisplay : public I2C_ssd1306 {
+  public:
+    TestDisplay() : I2C_ssd1306(128, 64, 0x3C) {}
+    bool bufferPixel(uint8_t x, uint8_t y) { return (_screenBuffer[(y >> 3) * _width + x] >> (y & 7)) & 1; }
+    uint8_t bufferByte(uint8_t page, uint8_t x) { return _screenBuffer[page * _width + x]; }
+};
+
+static bool sameAsBuffer(SSD_EmulatorTransport &emulator, TestDisplay &display) {
+  for(uint8_t y = 0; y < 64; y++){
+    for(uint8_t x = 0; x < 128; x++){
+      if(emulator.getRAMPixel(x, y) != display.bufferPixel(x, y)) return false;
+    }
+  }
+  return true;
+}
+
+static bool sameRAM(SSD_EmulatorTransport &a, SSD_EmulatorTransport &b) {
+  for(uint8_t page = 0; page < 8; page++){
+    for(uint8_t x = 0; x < 128; x++){
+      if(a.getRAMByte(page, x) != b.getRAMByte(page, x)) return false;
+    }
+  }
+  return true;
+}
+
+static bool sameBuffer(TestDisplay &a, TestDisplay &b) {
+  for(uint8_t page = 0; page < 8; page++){
+    for(uint8_t x = 0; x < 128; x++){
+      if(a.bufferByte(page, x) != b.bufferByte(page, x)) return false;
+    }
+  }
+  return true;
+}
+
+static void drawScene(I2C_ssd1306 &display, uint8_t seed) {
+  srand(seed);
+  for(uint8_t i = 0; i < 12; i++){
+    uint8_t x = rand() % 128, y = rand() % 64, color = rand() % 3;
+    switch(rand() % 6){
+      case 0: display.fillRect(x, y, rand() % 40 + 1, rand() % 30 + 1, color); break;
+      case 1: display.drawLine(x, y, rand() % 128, rand() % 64, color); break;
+      case 2: display.drawCircle(x, y, rand() % 20, color); break;
+      case 3: display.fillCircle(x, y, rand() % 15, color); break;
+      case 4: display.drawRect(x, y, rand() % 50 + 1, rand() % 30 + 1, color); break;
+      default:
+        display.setFont(rand() % 2 ? Picopixel5x6 : Roboto10x12);
+        display.setTextScale(rand() % 3 + 1);
+        display.setCursorCoord(x, y);
+        display.drawText("Ab9 x!", color);
+        break;
+    }
+  }
+}
+
+//same random pixels on every display given the same seed, so inverse drawing has something to invert
+static void drawBackground(I2C_ssd1306 &display, uint8_t seed) {
+  srand(seed * 31 + 7);
+  for(uint16_t i = 0; i < 600; i++) display.drawPixel(rand() % 128, rand() % 64, SSD_COLOR_WHITE);
+}
+
+/*
+  test image: lit pixels are kept in the middle so the edges of the bounding box stay blank,
+  stored as XBM rows, in the native page-major format and compressed like drawBitmapRLE() expects
+*/
+#define TEST_IMAGE_MAX 40
+static uint8_t imageWidth, imageHeight;
+static bool imagePixels[TEST_IMAGE_MAX][TEST_IMAGE_MAX];
+static uint8_t imageXBM[TEST_IMAGE_MAX * ((TEST_IMAGE_MAX + 7) / 8)];
+static uint8_t imageNative[SSD_BITMAP_HEADER_SIZE + TEST_IMAGE_MAX * ((TEST_IMAGE_MAX + 7) / 8)];
+static uint8_t imageRLE[2 * sizeof(imageNative)];
+
+//longest run of the same byte from i, up to the longest run a code byte holds
+static uint8_t runLength(const uint8_t *data, uint16_t i, uint16_t length) {
+  uint8_t run = 1;
+  while(i + run < length && data[i + run] == data[i] && run < 64) run++;
+  return run;
+}
+
+static void encodeRLE(const uint8_t *data, uint16_t length, uint8_t *out) {
+  uint16_t i = 0;
+  while(i < length){
+    uint8_t run = runLength(data, i, length);
+    if(data[i] == 0 && run >= 2){
+      *out++ = SSD_RLE_ZEROS | (run - 1);
+      i += run;
+    }else if(run >= 3){
+      *out++ = SSD_RLE_REPEAT | (run - 1);
+      *out++ = data[i];
+      i += run;
+    }else{
+      uint16_t start = i;
+      while(i < length && i - start < SSD_RLE_ZEROS){
+        run = runLength(data, i, length);
+        if(run >= 3 || (data[i] == 0 && run >= 2)) break;
+        i++;
+      }
+      *out++ = i - start - 1;
+      memcpy(out, data + start, i - start);
+      out += i - start;
+    }
+  }
+}
+
+static void makeImage(uint8_t seed) {
+  srand(seed * 13 + 1);
+  imageWidth = rand() % TEST_IMAGE_MAX + 1;
+  imageHeight = rand() % TEST_IMAGE_MAX + 1;
+  uint8_t widthInBytes = (imageWidth + 7) >> 3, pages = (imageHeight + 7) >> 3;
+  memset(imageXBM, 0, sizeof(imageXBM));
+  memset(imageNative, 0, sizeof(imageNative));
+  imageNative[0] = imageWidth;
+  imageNative[1] = imageHeight;
+  for(uint8_t y = 0; y < imageHeight; y++){
+    for(uint8_t x = 0; x < imageWidth; x++){
+      bool inner = x >= imageWidth / 4 && x < imageWidth - imageWidth / 4 && y >= imageHeight / 4;
+      //solid and blank rows too, so the compressed image has runs of both
+      imagePixels[y][x] = inner && (y % 5 == 0 || (y % 5 != 1 && rand() % 3 == 0));
+      if(!imagePixels[y][x]) continue;
+      imageXBM[y * widthInBytes + (x >> 3)] |= 1 << (x & 7);
+      imageNative[SSD_BITMAP_HEADER_SIZE + (y >> 3) * imageWidth + x] |= 1 << (y & 7);
+    }
+  }
+  encodeRLE(imageNative + SSD_BITMAP_HEADER_SIZE, pages * imageWidth, imageRLE + SSD_BITMAP_HEADER_SIZE);
+  imageRLE[0] = imageWidth;
+  imageRLE[1] = imageHeight;
+}
+
+static void drawImageReference(I2C_ssd1306 &display, int16_t x0, int16_t y0, uint8_t color) {
+  for(uint8_t y = 0; y < imageHeight; y++){
+    for(uint8_t x = 0; x < imageWidth; x++){
+      if(imagePixels[y][x]) display.drawPixel(x0 + x, y0 + y, color);
+    }
+  }
+}
+
+#define IMAGE_XBM 0
+#define IMAGE_NATIVE 1
+#define IMAGE_RLE 2
+
+static void drawImage(I2C_ssd1306 &display, uint8_t format, uint8_t x0, uint8_t y0, uint8_t color) {
+  switch(format){
+    case IMAGE_XBM: display.drawXBM(imageXBM, imageWidth, imageHeight, x0, y0, color); break;
+    case IMAGE_NATIVE: display.drawBitmap(imageNative, x0, y0, color); break;
+    default: display.drawBitmapRLE(imageRLE, x0, y0, color); break;
+  }
+}
+
+//Roboto10x12 with its glyphs stored page by page, the format extras/font_converter.py makes
+static uint8_t pageMajorRoboto[4096];
+
+static void makePageMajorFont(const uint8_t *font, uint8_t *out) {
+  uint16_t first = font[2] | font[3] << 8, last = font[4] | font[5] << 8;
+  uint8_t height = font[6], pages = (height + 7) >> 3;
+  uint32_t offset = 8 + (last - first + 1) * 4;
+  memcpy(out, font, 8);
+  out[0] = SSD_FONT_PAGE_MAJOR;
+  for(uint16_t c = first; c <= last; c++){
+    const uint8_t *entry = font + 8 + (c - first) * 4;
+    const uint8_t *glyph = font + (entry[1] | entry[2] << 8 | (uint32_t)entry[3] << 16);
+    uint8_t width = entry[0], widthInBytes = (width + 7) >> 3;
+    uint8_t *outEntry = out + 8 + (c - first) * 4;
+    outEntry[0] = width;
+    outEntry[1] = offset;
+    outEntry[2] = offset >> 8;
+    outEntry[3] = offset >> 16;
+    memset(out + offset, 0, width * pages);
+    for(uint8_t y = 0; y < height; y++){
+      for(uint8_t x = 0; x < width; x++){
+        if((glyph[y * widthInBytes + (x >> 3)] >> (x & 7)) & 1) out[offset + (y >> 3) * width + x] |= 1 << (y & 7);
+      }
+    }
+    offset += width * pages;
+  }
+}
+
+/*
+  text drawn pixel by pixel from a MikroElektronika font, scale x scale blocks per glyph pixel, with the default spacing.
+  Measures it like measureText() should
+*/
+static void drawTextReference(I2C_ssd1306 *display, const uint8_t *font, const char *text, uint8_t x0, uint8_t y0, uint8_t scale, uint8_t color, uint16_t &width, uint16_t &height) {
+  const uint8_t letterSpacing = 1, lineSpacing = 2;
+  uint16_t first = font[2] | font[3] << 8, last = font[4] | font[5] << 8;
+  uint8_t charHeight = font[6], lines = 1;
+  uint8_t x = x0, y = y0; //8 bit like the display's cursor, a line longer than 255 columns wraps around
+  int16_t lineWidth = 0;
+  bool lineEmpty = true;
+  width = 0;
+  for(const char *c = text; *c; c++){
+    if(*c == '\n'){
+      if(!lineEmpty && lineWidth - letterSpacing > (int16_t)width) width = lineWidth - letterSpacing;
+      x = 0;
+      y += charHeight * scale + lineSpacing;
+      lineWidth = 0;
+      lineEmpty = true;
+      lines++;
+      continue;
+    }
+    if(*c == ' '){
+      x += scale + letterSpacing;
+      lineWidth += scale + letterSpacing;
+      lineEmpty = false;
+      continue;
+    }
+    if((uint8_t)*c < first || (uint8_t)*c > last) continue;
+    const uint8_t *entry = font + 8 + ((uint8_t)*c - first) * 4;
+    const uint8_t *glyph = font + (entry[1] | entry[2] << 8 | (uint32_t)entry[3] << 16);
+    uint8_t charWidth = entry[0], widthInBytes = (charWidth + 7) >> 3;
+    for(uint8_t gy = 0; gy < charHeight && display != NULL; gy++){
+      for(uint8_t gx = 0; gx < charWidth; gx++){
+        if(!((glyph[gy * widthInBytes + (gx >> 3)] >> (gx & 7)) & 1)) continue;
+        for(uint8_t sy = 0; sy < scale; sy++){
+          for(uint8_t sx = 0; sx < scale; sx++) display->drawPixel(x + gx * scale + sx, y + gy * scale + sy, color);
+        }
+      }
+    }
+    x += charWidth * scale + letterSpacing;
+    lineWidth += charWidth * scale + letterSpacing;
+    lineEmpty = false;
+  }
+  if(!lineEmpty && lineWidth - letterSpacing > (int16_t)width) width = lineWidth - letterSpacing;
+  height = *text ? lines * charHeight * scale + (lines - 1) * lineSpacing : 0;
+}
+
+static void testShapes() {
+  SSD_EmulatorTransport emulator(128, 64);
+  TestDisplay display;
+  display.begin(emulator);
+  display.fillRect(10, 6, 5, 4, SSD_COLOR_WHITE);
+  display.drawPixel(127, 63, SSD_COLOR_WHITE);
+  display.drawHLine(0, 20, 127, SSD_COLOR_WHITE);
+  display.display();
+  uint16_t lit = 0;
+  for(uint8_t y = 0; y < 64; y++){
+    for(uint8_t x = 0; x < 128; x++){
+      bool inRect = x >= 10 && x < 15 && y >= 6 && y < 10;
+      bool expected = inRect || (x == 127 && y == 63) || y == 20;
+      if(emulator.getRAMPixel(x, y) != expected) failures += lit++ == 0 ? 1 : 0;
+    }
+  }
+  CHECK(lit == 0);
+  display.fillRect(10, 6, 5, 4, SSD_COLOR_INVERSE);
+  display.display();
+  CHECK(!emulator.getRAMPixel(10, 6) && !emulator.getRAMPixel(14, 9) && emulator.getRAMPixel(127, 63));
+}
+
+static void testScenes() {
+  for(uint8_t seed = 1; seed <= 20; seed++){
+    SSD_EmulatorTransport plain(128, 64), diff(128, 64), doubled(128, 64), stepped(128, 64);
+    TestDisplay plainDisplay, diffDisplay, doubleDisplay, steppedDisplay;
+    plainDisplay.begin(plain);
+    diffDisplay.begin(diff);
+    doubleDisplay.begin(doubled);
+    steppedDisplay.begin(stepped);
+    CHECK(diffDisplay.setFrameDiff(true));
+    CHECK(doubleDisplay.setDoubleBuffer(true));
+    //two frames, so the second one is sent as a difference and from the other buffer
+    for(uint8_t frame = 0; frame < 2; frame++){
+      plainDisplay.clearDisplay();
+      diffDisplay.clearDisplay();
+      doubleDisplay.clearDisplay();
+      steppedDisplay.clearDisplay();
+      drawScene(plainDisplay, seed + frame);
+      drawScene(diffDisplay, seed + frame);
+      drawScene(doubleDisplay, seed + frame);
+      drawScene(steppedDisplay, seed + frame);
+      plainDisplay.display();
+      diffDisplay.display();
+      doubleDisplay.present();
+      doubleDisplay.present();
+      steppedDisplay.beginDisplay();
+      while(steppedDisplay.displayStep(7));
+      CHECK(sameAsBuffer(plain, plainDisplay));
+      CHECK(sameRAM(plain, diff));
+      CHECK(sameRAM(plain, doubled));
+      CHECK(sameRAM(plain, stepped));
+    }
+  }
+}
+
+//horizontal and vertical spans and filled rectangles against the same pixels drawn one by one
+static void testSpans() {
+  for(uint8_t seed = 1; seed <= 60; seed++){
+    SSD_EmulatorTransport fastRAM(128, 64), referenceRAM(128, 64);
+    TestDisplay fast, reference;
+    fast.begin(fastRAM);
+    reference.begin(referenceRAM);
+    drawBackground(fast, seed);
+    drawBackground(reference, seed);
+    fast.display();
+    reference.display();
+    srand(seed);
+    int16_t x0 = rand() % 150 - 10, x1 = rand() % 150 - 10, y0 = rand() % 80 - 8, y1 = rand() % 80 - 8;
+    uint8_t color = rand() % 3, width = rand() % 60 + 1, height = rand() % 40 + 1;
+    uint8_t x = rand() % 128, y = rand() % 64;
+    fast.drawHLine(x0, y0, x1, color);
+    for(int16_t i = x0 < x1 ? x0 : x1; i <= (x0 < x1 ? x1 : x0); i++) reference.drawPixel(i, y0, color);
+    fast.drawVLine(x1, y0, y1, color);
+    for(int16_t i = y0 < y1 ? y0 : y1; i <= (y0 < y1 ? y1 : y0); i++) reference.drawPixel(x1, i, color);
+    fast.fillRect(x, y, width, height, color);
+    for(uint8_t i = 0; i < height; i++){
+      for(uint8_t j = 0; j < width; j++) reference.drawPixel(x + j, y + i, color);
+    }
+    CHECK(sameBuffer(fast, reference));
+    fast.display();
+    reference.display();
+    CHECK(sameRAM(fastRAM, referenceRAM));
+  }
+}
+
+//XBM transpose, native and compressed bitmaps against the image drawn pixel by pixel
+static void testBitmaps() {
+  for(uint8_t seed = 1; seed <= 40; seed++){
+    makeImage(seed);
+    for(uint8_t format = IMAGE_XBM; format <= IMAGE_RLE; format++){
+      SSD_EmulatorTransport fastRAM(128, 64), referenceRAM(128, 64);
+      TestDisplay fast, reference;
+      fast.begin(fastRAM);
+      reference.begin(referenceRAM);
+      drawBackground(fast, seed);
+      drawBackground(reference, seed);
+      fast.display();
+      reference.display();
+      srand(seed + format);
+      uint8_t x = rand() % 136, y = rand() % 70, color = rand() % 3;
+      drawImage(fast, format, x, y, color);
+      drawImageReference(reference, x, y, color);
+      CHECK(sameBuffer(fast, reference));
+      fast.display();
+      reference.display();
+      CHECK(sameRAM(fastRAM, referenceRAM));
+    }
+  }
+}
+
+//row-major and page-major glyphs, scaled with the expansion tables and as blocks, with and without the glyph cache
+static void testText() {
+  const uint8_t *fonts[] = {Picopixel5x6, Roboto10x12, pageMajorRoboto};
+  const uint8_t *sources[] = {Picopixel5x6, Roboto10x12, Roboto10x12};
+  const char *text = "AAb9 xAb!\nQy9A";
+  makePageMajorFont(Roboto10x12, pageMajorRoboto);
+  for(uint8_t font = 0; font < 3; font++){
+    for(uint8_t scale = 1; scale <= SSD_MAX_EXPANDED_SCALE + 1; scale++){
+      for(uint8_t cached = 0; cached < 2; cached++){
+        SSD_EmulatorTransport fastRAM(128, 64), referenceRAM(128, 64);
+        TestDisplay fast, reference;
+        fast.begin(fastRAM);
+        reference.begin(referenceRAM);
+        uint8_t seed = font * 20 + scale * 2 + cached;
+        drawBackground(fast, seed);
+        drawBackground(reference, seed);
+        fast.display();
+        reference.display();
+        srand(seed);
+        uint8_t x = rand() % 64, y = rand() % 50, color = rand() % 3;
+        uint16_t width, height, measuredWidth, measuredHeight;
+        fast.setFont(fonts[font]);
+        fast.setTextScale(scale);
+        if(cached) CHECK(fast.setGlyphCache(2000));
+        fast.setCursorCoord(x, y);
+        fast.drawText(text, color);
+        drawTextReference(&reference, sources[font], text, x, y, scale, color, width, height);
+        CHECK(sameBuffer(fast, reference));
+        fast.display();
+        reference.display();
+        CHECK(sameRAM(fastRAM, referenceRAM));
+        if(cached && scale <= SSD_MAX_EXPANDED_SCALE) CHECK(fast.getGlyphCacheHits() > 0);
+        fast.measureText(text, measuredWidth, measuredHeight);
+        CHECK(measuredWidth == width && measuredHeight == height);
+      }
+    }
+  }
+  TestDisplay display;
+  uint16_t width, height;
+  display.setFont(Roboto10x12);
+  display.measureText("", width, height);
+  CHECK(width == 0 && height == 0);
+  display.measureText("\n\nAb", width, height);
+  CHECK(width == display.getTextWidth("Ab") && height == 3 * 12 + 2 * 2);
+}
+
+//text laid out in a box stays in it, and paging through it with the returned index shows every char once
+static void testTextBox() {
+  const char *text = "The quick brown fox jumps over the lazy dog, then naps.\nEnd";
+  for(uint8_t flags = 0; flags <= (SSD_ALIGN_RIGHT | SSD_ALIGN_BOTTOM | SSD_TEXT_ELLIPSIS); flags++){
+    if((flags & 0x03) == 0x03 || (flags & 0x0C) == 0x0C) continue;
+    TestDisplay display;
+    display.setFont(Picopixel5x6);
+    display.clearDisplay();
+    uint16_t shown = display.drawTextBox(text, 20, 10, 40, 14, flags, SSD_COLOR_WHITE);
+    CHECK(shown > 0 && shown < strlen(text));
+    bool outside = false;
+    for(uint8_t y = 0; y < 64; y++){
+      for(uint8_t x = 0; x < 128; x++) outside |= display.bufferPixel(x, y) && (x < 20 || x >= 60 || y < 10 || y >= 24);
+    }
+    CHECK(!outside);
+    //text up to the returned index fits in the same box without the ellipsis
+    char shownText[64];
+    memcpy(shownText, text, shown);
+    shownText[shown] = 0;
+    CHECK(display.drawTextBox(shownText, 20, 10, 40, 14, flags & ~SSD_TEXT_ELLIPSIS, SSD_COLOR_WHITE) == shown);
+    uint16_t position = 0;
+    uint8_t pages = 0;
+    while(text[position] && pages < 20){
+      uint16_t next = display.drawTextBox(text + position, 20, 10, 40, 14, flags, SSD_COLOR_WHITE);
+      CHECK(next > 0);
+      position += next;
+      while(text[position] == ' ' || text[position] == '\n') position++;
+      pages++;
+    }
+    CHECK(text[position] == 0);
+  }
+}
+
+static void testScroll() {
+  SSD_EmulatorTransport emulator(128, 64);
+  TestDisplay display;
+  display.begin(emulator);
+  display.fillRect(0, 0, 10, 10, SSD_COLOR_WHITE);
+  display.display();
+  display.startScrollHorizontal(SSD_SCROLL_LEFT, 0, 7, SSD_SCROLL_FRAMES_2);
+  CHECK(display.isScrolling() && emulator.isScrolling());
+  //GDDRAM isn't written while scrolling, the drawing goes out after the scroll stops
+  display.fillRect(20, 20, 5, 5, SSD_COLOR_WHITE);
+  display.display();
+  CHECK(!display.beginDisplay());
+  CHECK(!emulator.getRAMPixel(20, 20));
+  display.stopScroll();
+  CHECK(!display.isScrolling() && !emulator.isScrolling());
+  display.display();
+  CHECK(sameAsBuffer(emulator, display));
+  display.setVerticalScrollArea(8, 56);
+  display.startScrollDiagonal(SSD_SCROLL_RIGHT, 1, 6, SSD_SCROLL_FRAMES_5, 1);
+  CHECK(display.isScrolling() && emulator.isScrolling());
+  display.stopScroll();
+  CHECK(!emulator.isScrolling());
+}
+
+static void testCommandQueue() {
+  SSD_EmulatorTransport emulator(128, 64);
+  TestDisplay display;
+  display.begin(emulator);
+  display.setDeferredCommands(true);
+  uint32_t transactions = emulator.getTransactions();
+  display.setContrast(0x42);
+  display.invertDisplay(true);
+  display.setContrast(0x43);
+  CHECK(emulator.getTransactions() == transactions && emulator.getContrast() != 0x43 && !emulator.isInverted());
+  //queued commands go out in the same transaction as the window commands
+  display.drawPixel(1, 1, SSD_COLOR_WHITE);
+  display.display();
+  CHECK(emulator.getTransactions() == transactions + 2);
+  CHECK(emulator.getContrast() == 0x43 && emulator.isInverted() && emulator.getRAMPixel(1, 1));
+  display.setDisplayOn(false);
+  CHECK(emulator.isDisplayOn());
+  display.flushCommands();
+  CHECK(!emulator.isDisplayOn());
+  display.setDeferredCommands(false);
+  display.setContrast(0x10);
+  CHECK(emulator.getContrast() == 0x10);
+}
+
+static void testMinimal() {
+  SSD_EmulatorTransport emulator(128, 64);
+  I2C_ssd1306_minimal display(128, 64, 0x3C);
+  display.begin(emulator);
+  display.clearDisplay();
+  CHECK(!display.setFrameDiff(true));
+  CHECK(!display.setDoubleBuffer(true));
+  //auto mode sends a page when drawing moves on to another one, the stepped transfer sends the current one
+  display.drawPixel(3, 2, SSD_COLOR_WHITE);
+  display.drawPixel(100, 42, SSD_COLOR_WHITE);
+  CHECK(display.beginDisplay());
+  while(display.displayStep());
+  CHECK(emulator.getRAMPixel(3, 2));
+  CHECK(emulator.getRAMPixel(100, 42));
+  CHECK(!emulator.getRAMPixel(4, 2));
+
+  //drawing on another page while a transfer is in flight finishes the transfer before the page is sent
+  display.clearDisplay();
+  display.fillRect(0, 0, 128, 8, SSD_COLOR_WHITE);
+  CHECK(display.beginDisplay());
+  display.displayStep();
+  display.drawPixel(5, 3, SSD_COLOR_WHITE);
+  display.drawPixel(5, 30, SSD_COLOR_WHITE);
+  display.display();
+  bool pageWhite = true;
+  for(uint8_t x = 0; x < 128; x++) pageWhite &= emulator.getRAMByte(0, x) == 0xFF;
+  CHECK(pageWhite);
+  CHECK(emulator.getRAMPixel(5, 30));
+}
+
+/*
+  the minimal class sends the dirty columns of its page buffer over whatever GDDRAM holds, so drawing must mark
+  only the columns per-pixel drawing would: blank columns at the sides of an image or a glyph leave GDDRAM as it is
+*/
+static void testMinimalDirty() {
+  for(uint8_t seed = 1; seed <= 10; seed++){
+    makeImage(seed);
+    for(uint8_t kind = IMAGE_XBM; kind <= IMAGE_RLE + 1; kind++){
+      SSD_EmulatorTransport fastRAM(128, 64), referenceRAM(128, 64);
+      I2C_ssd1306_minimal fast(128, 64, 0x3C), reference(128, 64, 0x3C);
+      fast.begin(fastRAM);
+      reference.begin(referenceRAM);
+      fast.setMinimalMode(SSD_MINIMAL_MODE_MANUAL);
+      reference.setMinimalMode(SSD_MINIMAL_MODE_MANUAL);
+      fast.streamFill(0xFF, 0, 0, 128, 8);
+      reference.streamFill(0xFF, 0, 0, 128, 8);
+      fast.setFont(Roboto10x12);
+      fast.setTextScale(2);
+      srand(seed + kind);
+      uint8_t x = rand() % 100, y = rand() % 50;
+      uint16_t width, height;
+      for(uint8_t page = 0; page < 8; page++){
+        fast.setPage(page);
+        reference.setPage(page);
+        if(kind <= IMAGE_RLE){
+          drawImage(fast, kind, x, y, SSD_COLOR_WHITE);
+          drawImageReference(reference, x, y, SSD_COLOR_WHITE);
+        }else{
+          fast.setCursorCoord(x, y);
+          fast.drawText("i.l", SSD_COLOR_WHITE);
+          drawTextReference(&reference, Roboto10x12, "i.l", x, y, 2, SSD_COLOR_WHITE, width, height);
+        }
+        fast.display();
+        reference.display();
+      }
+      CHECK(sameRAM(fastRAM, referenceRAM));
+    }
+  }
+}
+
+static void testTerminal() {
+  SSD_EmulatorTransport emulator(128, 64);
+  TestDisplay display;
+  display.begin(emulator);
+  display.setFont(Picopixel5x6);
+  CHECK(display.setTerminalMode(true));
+  //8 rows of 8 lines, the 9th scrolls the display start line by one row
+  for(uint8_t row = 0; row < 8; row++) display.print("Ab9\n");
+  display.print("x");
+  display.display();
+  CHECK(emulator.getStartLine() == 8);
+  CHECK(sameAsBuffer(emulator, display));
+  bool ink = false;
+  for(uint8_t x = 0; x < 8; x++) ink |= emulator.getRAMByte(0, x) != 0;
+  CHECK(ink); //the new row reuses page 0, which now shows at the bottom
+  for(uint8_t x = 0; x < 128; x++) CHECK(emulator.getPixel(x, 56) == emulator.getRAMPixel(x, 0));
+
+  //the minimal class only buffers one page, rows can't be scrolled in it
+  SSD_EmulatorTransport minimalEmulator(128, 64);
+  I2C_ssd1306_minimal minimal(128, 64, 0x3C);
+  minimal.begin(minimalEmulator);
+  minimal.setFont(Picopixel5x6);
+  CHECK(!minimal.setTerminalMode(true));
+  for(uint8_t row = 0; row < 12; row++) minimal.print("line\n");
+  minimal.display();
+}
+
+int main() {
+  testShapes();
+  testScenes();
+  testSpans();
+  testBitmaps();
+  testText();
+  testTextBox();
+  testScroll();
+  testCommandQueue();
+  testMinimal();
+  testMinimalDirty();
+  testTerminal();
+  if(failures) printf("%d checks failed\n", failures);
+  else printf("all checks passed\n");
+  return failures ? 1 : 0;
+}
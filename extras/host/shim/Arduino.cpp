@@ -0,0 +1,16 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "SPI.h"
+#include <chrono>
+
+HardwareSerial Serial;
+TwoWire Wire;
+SPIClass SPI;
+
+unsigned long micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
@@ -0,0 +1,49 @@
+/*
+  the parts of the Arduino API the library uses, so it builds on a desktop compiler.
+  Flash is ordinary memory here, pins and timing do nothing
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_byte_near(address) pgm_read_byte(address)
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper *>(string))
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define MSBFIRST 1
+
+unsigned long micros();
+unsigned long millis();
+inline void delay(unsigned long) {}
+inline void yield() {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+#include "Print.h"
+
+//Serial prints to stdout
+class HardwareSerial : public Print {
+  public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
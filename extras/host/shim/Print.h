@@ -0,0 +1,29 @@
+#ifndef Print_h
+#define Print_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+class __FlashStringHelper;
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) { size_t n = 0; while(size--) n += write(*buffer++); return n; }
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t print(const char *text) { return write(text); }
+    size_t print(const __FlashStringHelper *text) { return write((const char *)text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long value) { char text[24]; snprintf(text, sizeof(text), "%ld", value); return write(text); }
+    size_t print(int value) { return print((long)value); }
+    size_t print(unsigned long value) { char text[24]; snprintf(text, sizeof(text), "%lu", value); return write(text); }
+    size_t print(unsigned int value) { return print((unsigned long)value); }
+    size_t print(double value) { char text[32]; snprintf(text, sizeof(text), "%.2f", value); return write(text); }
+    size_t println() { return write('\n'); }
+    template <class T> size_t println(T value) { size_t n = print(value); return n + println(); }
+};
+
+#endif
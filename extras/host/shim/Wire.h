@@ -0,0 +1,19 @@
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include "Arduino.h"
+
+//accepts and drops everything, host builds use a transport that doesn't need a bus
+class TwoWire {
+  public:
+    void begin() {}
+    void setClock(uint32_t) {}
+    void beginTransmission(uint8_t) {}
+    size_t write(uint8_t) { return 1; }
+    size_t write(const uint8_t *, size_t size) { return size; }
+    uint8_t endTransmission(bool = true) { return 0; }
+};
+
+extern TwoWire Wire;
+
+#endif